@@ -131,6 +131,13 @@
  * 		All injected function can be removed from the Executor object by
  * 		calling `executor.reset()` (this does NOT remove defined variables)
  *
+ * 		After all functions are injected, the program can be linked using the `link` method, it returns
+ * 		the names of all functions called by the program that are neither injected, defined or set by the program,
+ * 		so those can be reported before the program is started. Functions injected into parent executors are
+ * 		bound to the linked executor (changes made to them later are not visible to it), so their calls can be cached.
+ *
+ * 			std::vector<std::string> unresolved = exe.link( bb );
+ *
  * 4. Obtaining results
  *
  * 		After successful execution (exe.execute) of the program the returned value(s) can be
@@ -144,7 +151,8 @@
  *
  * 5. Using Sequensa streams and data types
  *
- * 		seq::Stream is a std::vector of seq::Generic's used to represent Sequensa streams (for both input and output)
+ * 		seq::Stream is a vector of seq::Generic's used to represent Sequensa streams (for both input and output),
+ * 		it provides the same interface as std::vector but keeps up to SEQ_STREAM_INLINE elements without allocating.
  * 		seq::Generic is an object used to represent Sequensa's data types and provide a simple interface to manipulate them.
  *
  * 			seq::Generic val = exe.getResult();
@@ -161,6 +169,21 @@
  *
  * 			}
  *
+ * 		Small values (bool, null, number, type, call and argument) are stored directly inside
+ * 		seq::Generic, other types are allocated on the heap and shared (reference counted) between
+ * 		copies, so they must not be modified in place. The anchor of a shared value is kept by each
+ * 		seq::Generic, so `setAnchor` doesn't need to copy it. Blobs are the exception, those are always
+ * 		copied using `Blob::copy`. The reference count is atomic, so copies can be used on different
+ * 		threads, but a single seq::Generic (or seq::Stream) must not be modified by two threads at once.
+ * 		Use the seq::util::new* functions to create new values.
+ *
+ * 		Heap allocated values (including user blobs) use seq::Pool, a thread local allocator that keeps
+ * 		free lists of blocks of up to 256 bytes. Its counters for the current thread can be obtained using
+ * 		`seq::Pool::getAllocations()`, `getReleases()` and `getChunks()`.
+ *
+ * 		Numbers with no fractional part are stored as 64 bit integers (see `Number::isNatural`), arithmetic
+ * 		on such numbers is exact and only falls back to floating point when the result overflows or is fractional.
+ *
  * 6. Exceptions and their meaning
  *
  * 		Sequnesa API can generate 3 types of exceptions:
@@ -235,6 +258,16 @@
  * 				Tries to pregenerate sorted name table, to possibly optimize index values,
  * 				and utilize the tiny storage (first 16 names) to it's fullest extent.
  *
+ * 			Optimizations::Slots
+ * 				Assigns a numeric slot to every variable name (excluding namespaced names, like 'std:pi'),
+ * 				slots are shared by all programs compiled using the same compiler object. The executor
+ * 				interns all names on its own, so the slots are only kept for compatibility
+ *
+ * 			Optimizations::TailCall
+ * 				Marks streams that end a function with a call to other function (in the form of
+ * 				`#return << #name << ...` or `#final << #name << ...`), so that the executor can
+ * 				reuse the stack level of the caller instead of nesting a new one
+ *
  * 		`Name` optimization requires the name table to be supplied:
  *
  * 			compiler.setNameTable( &stringTable );
@@ -245,6 +278,53 @@
  *
  * 		The Name optimization is unavailable for Compiler::compileStatic
  *
+ * 		The executor can also use an alternative engine, selected using the `setEngine` method:
+ *
+ * 			Engine::Tree (default value)
+ * 				Walks the decoded streams, checking the type of every entity
+ *
+ * 			Engine::Threaded
+ * 				Lowers every stream to an array of instructions (once per program) and
+ * 				executes it using threaded dispatch (computed goto, where supported)
+ *
+ * 			Engine::Register
+ * 				Lowers the whole program (when it's executed) to a linear sequence of register machine
+ * 				operations, and executes it without recursion, so deeply recursive programs
+ * 				don't exhaust the native stack (and can run on threads with small stacks),
+ * 				call frames are kept in the executor and reused between calls
+ *
+ * 		Both engines produce identical results.
+ *
+ * 		Pure functions (that don't use variables, natives or arguments of other functions)
+ * 		called with a single simple value are memoized by the tree and threaded engines, up to
+ * 		SEQ_MEMO_SIZE results per function. The results are discarded when the names called by
+ * 		the function start referring to different functions. This can be disabled using
+ * 		`setMemoization( false )`, `getCacheHits()` and `getCacheMisses()` return the cache statistics.
+ *
+ * 		Function bodies are split once per program by the tags of their streams, so streams tagged
+ * 		with `first;`, `last;` or `end;` cost nothing in iterations they don't match.
+ *
+ * 		Names are interned by the executor, each one gets a numeric slot when it's first used and variables
+ * 		are stored by those slots. Equal string constants of a program share a single value, so comparing
+ * 		them doesn't need to compare their characters.
+ *
+ * 		The executor remembers what each call of an anchored name resolved to (a native function, or the
+ * 		stack level holding the variable), later calls only check that it's still valid. Using `inject`,
+ * 		`define` or `reset` makes all calls resolve their names again.
+ *
+ * 		Expressions are decoded once per program into a tree, numeric subexpressions are then computed
+ * 		without creating intermediate values, other operands are evaluated as usual.
+ *
+ * 		Functions in form of `{ #return << (expression) }`, where the expression uses only numbers, arithmetic
+ * 		operators and the @ argument, called with at least SEQ_BATCH_MIN numbers are computed for the whole
+ * 		stream at once, using SIMD instructions where available (see seq::util::batch* functions). The same goes for
+ * 		flowcs applied to streams of numbers. Batches are used only if the result is guaranteed to be identical.
+ *
+ * 		On x86-64 Linux all engines also compile hot arithmetic expressions (+, -, *, / and comparisons
+ * 		of numbers and arguments) and numeric flowcs (values and ranges) to native code, after they were
+ * 		executed SEQ_JIT_THRESHOLD times. Non-numeric arguments are still handled by the interpreter.
+ * 		This can be disabled using `setJit( false )`, or at compile time using SEQ_EXCLUDE_JIT.
+ *
  * 9. Decompiler
  *
  * 		Sequensa API provides a simple to use decompiler class that allows to convert Sequensa Bytecode
@@ -281,6 +361,14 @@
  *			#define SEQ_IMPLEMENT - To implement the Sequensa API
  * 			#define SEQ_EXCLUDE_COMPILER - To exclude compiler code from the API
  * 			#define SEQ_EXCLUDE_DECOMPILER - To exclude decompiler code from the API
+ * 			#define SEQ_NO_COMPUTED_GOTO - To use switch based dispatch in the threaded engine
+ * 			#define SEQ_EXCLUDE_JIT - To exclude the native expression compiler from the API
+ * 			#define SEQ_JIT_THRESHOLD [number] - Number of executions after which expressions are compiled
+ * 			#define SEQ_MEMO_SIZE [number] - Maximum number of memoized results per function
+ * 			#define SEQ_EXCLUDE_SIMD - To use scalar code in the batch kernels
+ * 			#define SEQ_BATCH_MIN [number] - Minimal number of values processed using batch kernels
+ * 			#define SEQ_POOL_CHUNK [number] - Size (in bytes) of memory chunks allocated by seq::Pool
+ * 			#define SEQ_STREAM_INLINE [number] - Number of elements stored inside seq::Stream without allocating
  */
 
 #pragma once
@@ -290,21 +378,45 @@
 #include <cmath>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
+#include <list>
 #include <regex>
 #include <cfloat>
+#include <climits>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+#include <mutex>
+#include <iterator>
+#include <initializer_list>
+#include <stdexcept>
+#include <atomic>
+
+// the native compiler is only available on x86-64 Linux
+#if !defined( SEQ_EXCLUDE_JIT ) && defined( __linux__ ) && defined( __x86_64__ )
+#	define SEQ_JIT_NATIVE
+#	include <sys/mman.h>
+#endif
+
+// batch kernels use SSE2 (or AVX, if enabled) and fallback to scalar code otherwise
+#if !defined( SEQ_EXCLUDE_SIMD ) && ( defined( __SSE2__ ) || defined( _M_X64 ) )
+#	define SEQ_SIMD
+#	include <immintrin.h>
+#endif
 
 // public metadata
 #define SEQ_API_NAME "SeqAPI"
 #define SEQ_API_STANDARD "2021-04-08"
 #define SEQ_API_VERSION_MAJOR 2
 #define SEQ_API_VERSION_MINOR 1
-#define SEQ_API_VERSION_PATCH 0
+#define SEQ_API_VERSION_PATCH 1
 
 // enum ranges
 #define SEQ_MIN_OPCODE 1
-#define SEQ_MAX_OPCODE 17
+#define SEQ_MAX_OPCODE 19
 #define SEQ_MIN_DATA_TYPE 1
 #define SEQ_MAX_DATA_TYPE 13
 #define SEQ_MIN_CALL_TYPE 1
@@ -316,6 +428,46 @@
 #define SEQ_TAG_FIRST 1
 #define SEQ_TAG_LAST 2
 #define SEQ_TAG_END 4
+#define SEQ_TAG_TAIL 8 // not a real tag, marks streams that end with a call in tail position
+
+// variable slots
+#define SEQ_NO_SLOT ((unsigned int) -1)
+
+// register machine entries
+#define SEQ_NO_ENTRY ((unsigned int) -1)
+
+// memoization
+#ifndef SEQ_MEMO_SIZE
+#	define SEQ_MEMO_SIZE 256
+#endif
+
+// native compiler
+#ifndef SEQ_JIT_THRESHOLD
+#	define SEQ_JIT_THRESHOLD 64
+#endif
+#define SEQ_JIT_PAGE 4096
+#define SEQ_JIT_LIMIT 16777216.0
+
+// batch processing
+#ifndef SEQ_BATCH_MIN
+#	define SEQ_BATCH_MIN 8
+#endif
+
+// pool allocator, blocks of up to 256 bytes are pooled
+#define SEQ_POOL_STEP 16
+#define SEQ_POOL_CLASSES 16
+#ifndef SEQ_POOL_CHUNK
+#	define SEQ_POOL_CHUNK 16384
+#endif
+
+// number of variables searched linearly by seq::StackLevel
+#define SEQ_FLAT_VARS 8
+
+// number of elements stored inside seq::Stream, streams are kept in the C++ frames
+// of every recursive call made by the tree engine, so this has to stay small
+#ifndef SEQ_STREAM_INLINE
+#	define SEQ_STREAM_INLINE 1
+#endif
 
 namespace seq {
 
@@ -335,6 +487,8 @@ namespace seq {
 	class RuntimeError;
 	class Executor;
 	class FlowCondition;
+	class Generic;
+	class Stream;
 
 	/// Opcodes - operation identifiers
 	enum struct Opcode: byte {
@@ -351,6 +505,8 @@ namespace seq {
 		EXP = 11, // EXP [TYPE] [HEAD] [TAIL...] [L...] [R...] ;
 		VAR = 12, // VAR [ASCI...] ;
 		DEF = 13, // DEF [ASCI...] ;
+		SVR = 18, // SVR [HEAD] [TAIL...] [ASCI...] ;
+		SDF = 19, // SDF [HEAD] [TAIL...] [ASCI...] ;
 		FLC = 14, // FLC [SIZE] [[SIZE] [BODY...]...] ;
 		SSL = 15, // SSL [TAGS] [HEAD] [TAIL...] [BODY...] ;
 		FNE = 16, // FNE [HEAD] [TAIL...] [BODY...] ;
@@ -404,6 +560,49 @@ namespace seq {
 		const long denominator;
 	};
 
+	/// Thread local size-class allocator, used by all seq::type classes
+	class Pool {
+		public:
+			static void* allocate( size_t size );
+			static void release( void* ptr, size_t size ) noexcept;
+			static unsigned long getAllocations() noexcept;
+			static unsigned long getReleases() noexcept;
+			static unsigned long getChunks() noexcept;
+
+		private:
+			struct Block {
+				Block* next;
+			};
+
+			Pool() noexcept;
+			~Pool();
+
+			static Pool* local() noexcept;
+			static Block** shared() noexcept;
+			static std::mutex& lock() noexcept;
+			static Block* refill( size_t index, size_t size );
+
+			Block* lists[SEQ_POOL_CLASSES];
+			unsigned long allocations;
+			unsigned long releases;
+			unsigned long chunks;
+	};
+
+	/// Decision table of a flowc, built once from its conditions
+	class FlowMatcher {
+		public:
+			FlowMatcher( const std::vector<FlowCondition*>& conditions );
+			bool validate( Generic& arg ) const;
+			void validate( const double* values, byte* mask, size_t count ) const;
+
+		private:
+			std::unordered_set<std::string> strings;
+			std::unordered_set<double> numbers;
+			std::vector<std::pair<double, double>> ranges; // sorted, disjoint and exclusive
+			unsigned int types; // bit for each accepted type
+			byte bools; // bit 0 for false, bit 1 for true
+	};
+
 	namespace type {
 
 		class Null;
@@ -420,6 +619,9 @@ namespace seq {
 		class Bool;
 		class Generic;
 
+		/// define Sequensa native function signature
+		typedef seq::Stream*(*Native)(seq::Stream*);
+
 		class Generic {
 
 			private:
@@ -427,13 +629,25 @@ namespace seq {
 
 			protected:
 				Generic( const DataType type, bool anchor );
+				Generic( const Generic& generic );
 				bool anchor;
 
+			private:
+				// number of seq::Generic's sharing this (heap allocated) value
+				std::atomic<unsigned int> refs;
+				friend class seq::Generic;
+
 			public:
 				virtual ~Generic() {}
 				DataType getDataType() const noexcept;
 				bool getAnchor() const noexcept;
 				void setAnchor( bool anchor ) noexcept;
+
+				// all types (including user blobs) are allocated using seq::Pool
+				static void* operator new( size_t size );
+				static void* operator new( size_t size, void* ptr ) noexcept;
+				static void operator delete( void* ptr, size_t size ) noexcept;
+				static void operator delete( void* ptr, void* place ) noexcept;
 		};
 
 		class Bool: public Generic {
@@ -449,17 +663,23 @@ namespace seq {
 		class Number: public Generic {
 
 			public:
-				Number( bool anchor, long numerator, long denominator );
+				Number( bool anchor, int64_t numerator, int64_t denominator );
 				Number( bool anchor, double value );
 				double getDouble();
-				long getLong();
+				int64_t getLong();
 				bool isNatural();
 				const Fraction getFraction();
 				static byte sizeOfSigned( unsigned long value );
 				static byte sizeOf( unsigned long value );
 
 			private:
-				const double value;
+				// natural numbers are stored as integers
+				union {
+					double value;
+					int64_t integer;
+				};
+
+				bool natural;
 		};
 
 		class Arg: public Generic {
@@ -476,6 +696,7 @@ namespace seq {
 
 			public:
 				String( bool anchor, const char* value );
+				String( bool anchor, std::string&& value );
 				std::string& getString();
 
 			private:
@@ -514,12 +735,16 @@ namespace seq {
 		class Name: public Generic {
 
 			public:
-				Name( bool anchor, bool define, std::string name );
+				Name( bool anchor, bool define, std::string name, unsigned int slot = SEQ_NO_SLOT, const byte* origin = nullptr );
 				std::string& getName();
 				bool getDefine();
+				unsigned int getSlot();
+				const byte* getOrigin();
 
 			private:
 				const bool define;
+				const unsigned int slot;
+				const byte* origin; // address of the name in the bytecode, if it was loaded from one
 				std::string name;
 		};
 
@@ -560,9 +785,11 @@ namespace seq {
 				Flowc( const Flowc& flowc );
 				~Flowc();
 				const std::vector<FlowCondition*>& getConditions();
+				const FlowMatcher& getMatcher();
 
 			private:
 				const std::vector<FlowCondition*> conditions;
+				const FlowMatcher matcher;
 		};
 
 		class Stream: public Generic {
@@ -572,6 +799,7 @@ namespace seq {
 				Stream( const Stream& stream );
 				~Stream();
 				bool matchesTags( byte tags );
+				bool isTail();
 				byte getTags();
 				BufferReader& getReader();
 
@@ -603,8 +831,9 @@ namespace seq {
 		public:
 			Generic();
 			Generic( type::Generic* generic );
+			explicit Generic( const type::Generic& value );
 			Generic( const seq::Generic& generic );
-			Generic( seq::Generic&& generic );
+			Generic( seq::Generic&& generic ) noexcept;
 			~Generic();
 
 			Generic& operator= ( const Generic& generic );
@@ -629,30 +858,161 @@ namespace seq {
 			type::Bool& Bool();
 
 			type::Generic* getRaw();
+			bool isInline() const noexcept;
 
 		private:
 			type::Generic* generic;
 
+			union {
+				// small value types (Bool, Null, Number, Type, VMCall and Arg) are
+				// constructed in place inside this buffer instead of on the heap
+				alignas( type::Number ) byte storage[ sizeof( type::Number ) ];
+
+				// anchor of heap allocated values, those can be shared by copies with different anchors
+				bool anchor;
+			};
+
+			void release() noexcept;
+			void copyInline( const type::Generic* value ) noexcept;
+			void share( const seq::Generic& generic );
+
 	};
 
-	namespace type {
+	/// Sequensa stream, a vector of seq::Generic's that keeps
+	/// up to SEQ_STREAM_INLINE elements without allocating
+	class Stream {
 
-		/// define Sequensa native function signature
-		typedef std::vector<seq::Generic>*(*Native)(std::vector<seq::Generic>*);
+		public:
+			typedef seq::Generic value_type;
+			typedef seq::Generic& reference;
+			typedef const seq::Generic& const_reference;
+			typedef seq::Generic* iterator;
+			typedef const seq::Generic* const_iterator;
+			typedef std::reverse_iterator<iterator> reverse_iterator;
+			typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+			typedef size_t size_type;
+			typedef ptrdiff_t difference_type;
+
+			Stream() noexcept;
+			Stream( std::initializer_list<seq::Generic> list );
+			Stream( size_t count, const seq::Generic& value );
+			Stream( const Stream& stream );
+			Stream( Stream&& stream ) noexcept;
+			~Stream();
+
+			template< typename T >
+			Stream( T first, T last );
+
+			Stream& operator= ( const Stream& stream );
+			Stream& operator= ( Stream&& stream ) noexcept;
+			Stream& operator= ( std::initializer_list<seq::Generic> list );
+
+			size_t size() const noexcept;
+			size_t capacity() const noexcept;
+			bool empty() const noexcept;
+			bool isInline() const noexcept;
+
+			seq::Generic& operator[] ( size_t index ) noexcept;
+			const seq::Generic& operator[] ( size_t index ) const noexcept;
+			seq::Generic& at( size_t index );
+			const seq::Generic& at( size_t index ) const;
+			seq::Generic& front() noexcept;
+			const seq::Generic& front() const noexcept;
+			seq::Generic& back() noexcept;
+			const seq::Generic& back() const noexcept;
+			seq::Generic* data() noexcept;
+			const seq::Generic* data() const noexcept;
+
+			iterator begin() noexcept;
+			iterator end() noexcept;
+			const_iterator begin() const noexcept;
+			const_iterator end() const noexcept;
+			reverse_iterator rbegin() noexcept;
+			reverse_iterator rend() noexcept;
+			const_reverse_iterator rbegin() const noexcept;
+			const_reverse_iterator rend() const noexcept;
+
+			void reserve( size_t count );
+			void resize( size_t count );
+			void clear() noexcept;
+			void swap( Stream& stream ) noexcept;
+			void push_back( const seq::Generic& value );
+			void push_back( seq::Generic&& value );
+			void pop_back() noexcept;
+
+			template< typename... Args >
+			seq::Generic& emplace_back( Args&&... args );
+
+			iterator insert( const_iterator pos, const seq::Generic& value );
+			iterator insert( const_iterator pos, seq::Generic&& value );
+			iterator erase( const_iterator pos );
+			iterator erase( const_iterator first, const_iterator last );
+
+			template< typename T >
+			iterator insert( const_iterator pos, T first, T last );
+
+			template< typename T >
+			void assign( T first, T last );
 
+		private:
+			seq::Generic* elements;
+			size_t count;
+			size_t limit;
+
+			// first SEQ_STREAM_INLINE elements are constructed in place inside this buffer,
+			// the stream moves to the heap only once it outgrows it
+			alignas( seq::Generic ) byte storage[ SEQ_STREAM_INLINE * sizeof( seq::Generic ) ];
+
+			void grow( size_t count );
+			seq::Generic* open( size_t offset, size_t count );
+
+	};
+
+	template< typename T >
+	Stream::Stream( T first, T last ): Stream() {
+		this->insert( this->elements, first, last );
+	}
+
+	template< typename... Args >
+	seq::Generic& Stream::emplace_back( Args&&... args ) {
+		if( this->count == this->limit ) this->grow( this->count + 1 );
+		return *new (this->elements + this->count ++) seq::Generic( std::forward<Args>( args )... );
+	}
+
+	template< typename T >
+	Stream::iterator Stream::insert( const_iterator pos, T first, T last ) {
+		seq::Generic* gap = this->open( pos - this->elements, std::distance( first, last ) );
+		std::copy( first, last, gap );
+		return gap;
+	}
+
+	template< typename T >
+	void Stream::assign( T first, T last ) {
+		this->clear();
+		this->insert( this->elements, first, last );
 	}
 
 	namespace util {
 
 		byte packTags( const long pos, const long end ) noexcept;
 		constexpr long whole( const double val ) noexcept;
-		type::Generic* copyGeneric( const type::Generic* entity );
+		type::Generic* copyGeneric( const type::Generic* entity, void* storage = nullptr );
 		seq::Generic numberCast( seq::Generic arg );
 		seq::Generic boolCast( seq::Generic arg );
 		seq::Generic stringCast( seq::Generic arg );
 		std::vector<FlowCondition*> copyFlowConditions( const std::vector<FlowCondition*> conditions );
 		seq::Fraction asFraction( const double value );
 		seq::DataType toDataType( const std::string str );
+		bool naturalOperation( ExprOperator op, int64_t a, int64_t b, int64_t& result ) noexcept;
+
+		bool packNumbers( seq::Stream& stream, std::vector<double>& values );
+		void batchOperation( ExprOperator op, const double* a, const double* b, double* result, size_t count ) noexcept;
+		void batchRange( double min, double max, const double* values, byte* mask, size_t count ) noexcept;
+		void batchAbs( double* values, size_t count ) noexcept;
+		double batchBound( const double* values, size_t count ) noexcept;
+		double batchSum( const double* values, size_t count ) noexcept;
+		double batchMin( const double* values, size_t count ) noexcept;
+		double batchMax( const double* values, size_t count ) noexcept;
 
 		seq::Generic newBool( bool value, bool anchor = false ) noexcept;
 		seq::Generic newNumber( double value, bool anchor = false ) noexcept;
@@ -671,9 +1031,6 @@ namespace seq {
 
 	}
 
-	/// define shorthand for stream
-	typedef std::vector<seq::Generic> Stream;
-
 	/// Internal API error
 	class InternalError: public std::exception {
 
@@ -769,12 +1126,12 @@ namespace seq {
 			seq::Generic generic;
 
 			DataType getDataType( byte header );
-			type::Bool* loadBool();
-			type::Number* loadNumber();
-			type::Arg* loadArg();
+			type::Bool loadBool();
+			type::Number loadNumber();
+			type::Arg loadArg();
 			type::String* loadString();
-			type::Type* loadType();
-			type::VMCall* loadCall();
+			type::Type loadType();
+			type::VMCall loadCall();
 			type::Name* loadName();
 			type::Function* loadFunc();
 			type::Expression* loadExpr();
@@ -787,11 +1144,11 @@ namespace seq {
 
 		public:
 			ByteBuffer( byte* buffer, long length );
-			BufferReader getReader();
-			BufferReader getReader( long first, long last );
+			BufferReader getReader() const;
+			BufferReader getReader( long first, long last ) const;
 			void setStringTable( StringTable* table );
-			StringTable* getStringTable();
-			long size();
+			StringTable* getStringTable() const;
+			long size() const;
 
 		private:
 			byte* pointer;
@@ -839,7 +1196,7 @@ namespace seq {
 			void putString( bool anchor, const char* str );
 			void putType( bool anchor, DataType type );
 			void putCall( bool anchor, type::VMCall::CallType type );
-			void putName( bool anchor, bool define, const char* name );
+			void putName( bool anchor, bool define, const char* name, unsigned int slot = SEQ_NO_SLOT );
 			void putFunc( bool anchor, std::vector<byte>& buffer, bool end );
 			void putExpr( bool anchor, ExprOperator op, std::vector<byte>& left, std::vector<byte>& right );
 			void putStaticAccess( bool anchor, const char* str, byte index );
@@ -872,15 +1229,108 @@ namespace seq {
 			StackLevel( StackLevel&& level );
 			seq::Generic getArg();
 			Stream getVar( std::string& name, bool anchor );
-			void setVar( std::string& name, Stream value );
+			void setVar( std::string& name, Stream&& value );
 			bool hasVar( std::string& name );
+			Stream getSlot( unsigned int slot, bool anchor );
+			void setSlot( unsigned int slot, Stream&& value );
+			bool hasSlot( unsigned int slot );
+			bool isEmpty();
 			void setArg( seq::Generic arg );
+			void clear();
 
 		private:
 			seq::Generic arg;
-			std::unordered_map<std::string, Stream> vars;
+
+			// functions rarely define more than a few variables, so those are kept in a
+			// vector and searched linearly, the index is only built for bigger levels
+			std::vector<std::pair<std::string, Stream>> vars;
+			std::unordered_map<std::string, size_t> index;
+			std::vector<Stream> slots;
+			std::vector<bool> defined;
+
+			Stream* findVar( const std::string& name );
 	};
 
+	/// Stack of executor frames, popped frames are cleared but kept
+	/// (along with their storage) and reused by the next call
+	template< typename T >
+	class FrameStack {
+
+		public:
+			FrameStack();
+			FrameStack( const FrameStack& stack ) = delete;
+			FrameStack( FrameStack&& stack ) noexcept;
+			~FrameStack();
+
+			FrameStack& operator= ( const FrameStack& stack ) = delete;
+			FrameStack& operator= ( FrameStack&& stack ) noexcept;
+
+			T& push();
+			void pop();
+			T& back();
+			T& operator[] ( size_t index );
+			size_t size() const;
+
+		private:
+			// frames are allocated separately so that their addresses don't change
+			std::vector<T*> levels;
+			size_t count;
+	};
+
+	template< typename T >
+	FrameStack<T>::FrameStack(): count( 0 ) {}
+
+	template< typename T >
+	FrameStack<T>::FrameStack( FrameStack&& stack ) noexcept: levels( std::move( stack.levels ) ), count( stack.count ) {
+		stack.levels.clear();
+		stack.count = 0;
+	}
+
+	template< typename T >
+	FrameStack<T>::~FrameStack() {
+		for( T* level : this->levels ) delete level;
+	}
+
+	template< typename T >
+	FrameStack<T>& FrameStack<T>::operator= ( FrameStack&& stack ) noexcept {
+		if( this != &stack ) {
+			std::swap( this->levels, stack.levels );
+			std::swap( this->count, stack.count );
+		}
+		return *this;
+	}
+
+	template< typename T >
+	T& FrameStack<T>::push() {
+		if( this->count == this->levels.size() ) {
+			this->levels.push_back( new T() );
+		}
+
+		return *this->levels[ this->count ++ ];
+	}
+
+	template< typename T >
+	void FrameStack<T>::pop() {
+		this->levels[ -- this->count ]->clear();
+	}
+
+	template< typename T >
+	T& FrameStack<T>::back() {
+		return *this->levels[ this->count - 1 ];
+	}
+
+	template< typename T >
+	T& FrameStack<T>::operator[] ( size_t index ) {
+		return *this->levels[ index ];
+	}
+
+	template< typename T >
+	size_t FrameStack<T>::size() const {
+		return this->count;
+	}
+
+	typedef FrameStack<StackLevel> CallStack;
+
 	class FlowCondition {
 		public:
 			enum struct Type: byte {
@@ -908,12 +1358,191 @@ namespace seq {
 				None = 6,
 			};
 
-			CommandResult( ResultType stt, Stream acc );
+			CommandResult( ResultType stt );
+			CommandResult( ResultType stt, Stream&& acc );
 
 			ResultType stt;
 			Stream acc;
 	};
 
+	/// Executor engines
+	enum struct Engine: byte {
+		Tree = 1,     // walks the decoded streams
+		Threaded = 2, // runs streams lowered to instruction arrays
+		Register = 3  // runs whole programs lowered to register machine operations
+	};
+
+	/// Single instruction of the threaded engine
+	class Instruction {
+		public:
+			enum struct Op: byte {
+				Push = 0,   // append solid value to the accumulator
+				Eval = 1,   // compute expression or argument, then dispatch on the result
+				Stream = 2, // execute embedded stream
+				Call = 3,   // anchored VM call
+				Anchor = 4, // anchored function, flowc, name or cast
+				Set = 5,    // define variable
+				Get = 6,    // read variable
+				End = 7     // end of the stream
+			};
+
+			static Op classify( Generic& entity );
+
+			const void* label;
+			Generic* value;
+			Op op;
+	};
+
+	/// Single operation of the register machine
+	class Operation {
+		public:
+			enum struct Code: byte {
+				Push = 0,   // append solid value to the register
+				Eval = 1,   // compute expression or argument, then dispatch on the result
+				Call = 2,   // anchored VM call, passes the register to the function
+				Anchor = 3, // anchored function, flowc, name or cast, replaces the register
+				Set = 4,    // define variable from the register
+				Get = 5,    // append variable to the register
+				Open = 6,   // start embedded stream in the next register
+				Merge = 7,  // append the register to the previous one
+				Match = 8,  // skip function stream (to the target) if tags don't match
+				Done = 9,   // end of function stream
+				Next = 10   // load next function argument and jump to the target, or return
+			};
+
+			static Code classify( Generic& entity );
+
+			Generic* value;
+			unsigned int target;
+			unsigned int reg;
+			Code code;
+	};
+
+	/// Call frame of the register machine, used both for functions and anchored names
+	class RegisterFrame {
+		public:
+			RegisterFrame();
+			void open( unsigned int entry, Stream&& input, bool end, bool stack, unsigned int reg );
+			void open( Stream&& stream, unsigned int reg );
+			void clear();
+
+			Stream queue;
+			Stream out;
+			std::vector<Stream> regs;
+			long index;
+			long size;
+			unsigned int pc;
+			unsigned int stop;
+			unsigned int reg;
+			byte tags;
+			bool end: 1;
+			bool stack: 1;
+			bool dynamic: 1;
+	};
+
+#ifdef SEQ_JIT_NATIVE
+
+	/// Native (x86-64 SSE2) code generator for hot numeric expressions and flowcs
+	class JitCompiler {
+		public:
+			typedef double (*ExprFunc)( const double* args );
+			typedef int (*FlowcFunc)( double arg );
+
+			/// Compiled function along with its hotness counter
+			class Entry {
+				public:
+					Entry();
+
+					const void* code;
+					std::vector<double> constants;
+					std::vector<byte> levels;
+					unsigned int hits;
+					bool boolean;
+			};
+
+			JitCompiler();
+			JitCompiler( const JitCompiler& jit ) = delete;
+			~JitCompiler();
+			bool compileExpression( type::Expression& expr, Entry& entry );
+			bool compileFlowc( const std::vector<FlowCondition*>& fcs, Entry& entry );
+			size_t getCompiled();
+			void clear();
+
+		private:
+			bool emitNumeric( Generic& entity, byte reg, std::vector<byte>& code, std::vector<byte>& levels, double& bound );
+			bool emitOperands( type::Expression& expr, byte reg, std::vector<byte>& code, std::vector<byte>& levels, double* bounds );
+			static byte arithmetic( ExprOperator op );
+			static void emitConstant( double value, byte reg, std::vector<byte>& code );
+			const void* commit( std::vector<byte>& code );
+
+			std::vector<std::pair<byte*, size_t>> pages;
+			size_t compiled;
+	};
+
+#endif
+
+	/// Node of a decoded expression, operands are referenced by their index in the tree
+	class ExprNode {
+		public:
+			enum struct Kind: byte {
+				Value = 0, // constant operand
+				Arg = 1,   // argument of a function, resolved on each use
+				Pair = 2   // operator with two operands
+			};
+
+			/// Unboxed result of a numeric node
+			struct Scalar {
+				double real;
+				int64_t integer;
+				bool natural;
+			};
+
+			Generic value;
+			unsigned int left;
+			unsigned int right;
+			ExprOperator op;
+			Kind kind;
+			bool numeric; // node can only produce a number, if it produces anything
+	};
+
+	/// Decoded function body, with the indices of streams
+	/// executed for each combination of tags (see util::packTags)
+	class FunctionBody {
+		public:
+			FunctionBody( Stream& commands );
+
+			Stream* commands;
+
+			// indices of streams grouped by tags, streams matching
+			// the given tags are those in [offsets[tags], offsets[tags + 1])
+			std::vector<unsigned int> streams;
+			unsigned int offsets[9];
+	};
+
+	/// Inline cache of an anchored name, kept by the executor
+	/// for each call site (see Executor::resolveCall)
+	class CallSite {
+		public:
+			CallSite();
+
+			unsigned long generation; // generation of the executor that resolved the call
+			type::Native native; // called native, or null if the name refers to a variable
+			unsigned int level; // stack level holding the variable
+			unsigned int slot; // executor slot of the variable
+	};
+
+	/// Memoized results of a pure function, keyed by the argument
+	class FunctionCache {
+		public:
+			FunctionCache( bool pure, std::vector<std::string> names );
+
+			bool pure;
+			std::vector<std::string> names;
+			std::vector<const byte*> bindings;
+			std::list<std::pair<std::string, Stream>> entries;
+			std::unordered_map<std::string, std::list<std::pair<std::string, Stream>>::iterator> index;
+	};
+
 	class Executor {
 
 		public:
@@ -928,29 +1557,105 @@ namespace seq {
 			seq::Generic getResult();
 			seq::Stream& getResults();
 			void setStrictMath( bool flag );
-			void execute( ByteBuffer bb, seq::Stream args = { seq::Generic( new type::Null( false ) ) }, bool stack = true );
+			void setEngine( Engine engine );
+			void setJit( bool flag );
+			void setMemoization( bool flag );
+			unsigned long getCacheHits();
+			unsigned long getCacheMisses();
+			void execute( const ByteBuffer& bb, seq::Stream args = { seq::Generic( type::Null( false ) ) }, bool stack = true );
+			std::vector<std::string> link( const ByteBuffer& bb );
 
 		public: // use these methods only if you know what you are doing
-			void exit( seq::Stream& stream, byte code );
-			Stream executeFunction( BufferReader br, Stream& stream, bool end, bool stack = true );
-			CommandResult executeCommand( TokenReader* br, byte tags );
-			CommandResult executeStream( Stream& stream );
-			CommandResult executeAnchor( Generic entity, Stream& input_stream );
+			void exit( seq::Stream& stream, byte code ); // the stream is moved into the result
+			CommandResult executeFunction( BufferReader br, Stream stream, bool end, bool stack = true );
+			CommandResult executeCommand( Generic& command, byte tags );
+			CommandResult executeStream( Stream& stream, int first = 0 );
+			CommandResult executeTail( type::Stream& stream, Generic& callee );
+			CommandResult executeThreaded( Instruction* entry );
+			CommandResult executeRegister( unsigned int entry, Stream stream, bool end, bool stack = true );
+			CommandResult executeAnchor( Generic& entity, Stream& input_stream );
+			CommandResult executeMemoized( type::Function& func, Stream& input_stream );
+			FunctionCache* getMemo( type::Function& func, Generic& arg, std::string& key );
 			Generic executeExprPair( Generic left, Generic right, ExprOperator op, bool anchor );
-			Generic executeExpr( Generic entity );
+			Generic executeExpr( Generic& entity );
+			Generic executeTree( std::vector<ExprNode>& tree, unsigned int index, bool anchor );
+			bool executeNumber( std::vector<ExprNode>& tree, unsigned int index, ExprNode::Scalar& number );
+			std::vector<ExprNode>& getTree( type::Expression& expr );
+			unsigned int buildTree( std::vector<ExprNode>& tree, Generic entity );
+			bool executeBatch( type::Function& func, Stream& input_stream, Stream& output );
+			void executeBatchTree( std::vector<ExprNode>& tree, unsigned int index, const double* input, double* output, size_t count );
+			double boundTree( std::vector<ExprNode>& tree, unsigned int index, double bound );
+			Generic* getBatch( BufferReader& reader );
 			Stream resolveName( std::string& name, bool anchor );
-			void defineName( std::string& name, Stream& value, bool define = true );
-			Stream executeFlowc( std::vector<FlowCondition*> fcs, Stream& input_stream );
+			Stream resolveName( type::Name& name, bool anchor );
+			void defineName( std::string& name, Stream&& value, bool define = true );
+			void defineName( type::Name& name, Stream&& value );
+			unsigned int resolveSlot( type::Name& name );
+			unsigned int intern( const std::string& name );
+			void internString( Generic& entity );
+			Stream executeFlowc( type::Flowc& flowc, Stream& input_stream );
 			Generic executeCast( Generic cast, Generic arg );
 			type::Native resolveNative( std::string& name );
+			type::Native resolveCall( type::Name& name, Stream& stream );
 			std::unordered_map<std::string, type::Native>& getNativesMap();
+			Stream& decode( BufferReader& reader );
+			Instruction* lower( BufferReader& reader );
+			unsigned int lowerFunction( BufferReader& reader );
+			void lowerStream( Stream& stream, unsigned int reg, std::vector<std::pair<unsigned int, BufferReader>>& pending );
+			bool isClosed( BufferReader& reader );
+			bool isClosed( Stream& body, int depth );
+			bool isPure( Stream& body, int depth, std::vector<std::string>& names );
+			void linkNames( Stream& body, std::vector<std::string>& called, std::unordered_set<std::string>& defined );
+			bool hasName( std::string& name );
+			bool resolveBindings( FunctionCache& cache, std::vector<const byte*>& bindings );
+			FunctionCache& getCache( BufferReader& reader );
+			FunctionBody& getBody( BufferReader& reader );
+#ifdef SEQ_JIT_NATIVE
+			bool executeNative( type::Expression& expr, bool anchor, Generic& result );
+			bool executeNativeFlowc( const std::vector<FlowCondition*>& fcs, Stream& input_stream, Stream& acc );
+			JitCompiler& getJit();
+#endif
 
 		private:
 			std::unordered_map<std::string, type::Native> natives;
-			std::vector<StackLevel> stack;
+			std::unordered_map<const byte*, seq::Stream> decoded;
+			std::unordered_map<const byte*, FunctionBody> bodies;
+			std::unordered_map<const byte*, std::vector<Instruction>> lowered;
+			std::unordered_map<const byte*, unsigned int> functions;
+			std::unordered_map<const byte*, bool> closures;
+			std::unordered_map<const byte*, FunctionCache> caches;
+			std::unordered_map<const byte*, std::vector<ExprNode>> trees;
+			std::unordered_map<const byte*, Generic*> batches;
+			std::unordered_map<const byte*, CallSite> sites;
+			std::unordered_map<const byte*, unsigned int> names; // slots of names loaded from the bytecode
+			std::vector<Operation> operations;
+#ifdef SEQ_JIT_NATIVE
+			std::unordered_map<const byte*, JitCompiler::Entry> nativeExprs;
+			std::unordered_map<const FlowCondition*, JitCompiler::Entry> nativeFlowcs;
+			JitCompiler jit;
+#endif
+			std::unordered_map<std::string, unsigned int> symbols; // slots of all names used by this executor
+			std::unordered_map<std::string, Generic> strings; // string constants of the program
+			std::vector<std::pair<const byte*, const byte*>> buffers; // bytecode of the programs being executed
+			CallStack stack;
+			FrameStack<RegisterFrame> frames;
 			seq::Stream result;
 			Executor* parent;
+			int depth;
+			unsigned long cacheHits;
+			unsigned long cacheMisses;
+			unsigned long generation;
+			Engine engine;
 			bool strictMath: 1;
+			bool jitEnabled: 1;
+			bool memoization: 1;
+
+			void invalidate();
+			void releaseBuffer( size_t mark );
+			static unsigned long unique();
+
+			template<typename T>
+			static void forget( std::unordered_map<const byte*, T>& map, const byte* first, const byte* last );
 	};
 
 #ifndef SEQ_EXCLUDE_COMPILER
@@ -960,11 +1665,13 @@ namespace seq {
 
 	// read more about this enum in documentation at section 8.
 	enum struct Optimizations: oflag_t {
-		None = 0b0000,
-		All = 0b1111,
-		Name = 0b1000,
-		PureExpr = 0b0100,
-		StrPreGen = 0b0010
+		None = 0b00000,
+		All = 0b11111,
+		TailCall = 0b10000,
+		Name = 0b01000,
+		PureExpr = 0b00100,
+		StrPreGen = 0b00010,
+		Slots = 0b00001
 	};
 
 	class Compiler {
@@ -1027,6 +1734,7 @@ namespace seq {
 			StringTable* loades;
 			ErrorHandle handle;
 			oflag_t flags;
+			std::unordered_map<std::string, unsigned int> slots;
 
 		public:
 			Compiler();
@@ -1051,6 +1759,7 @@ namespace seq {
 			int findStreamEnd( std::vector<Token>& tokens, int start, int end );
 			int findOpening( std::vector<Token>& tokens, int index, Token::Category type );
 			int findClosing( std::vector<Token>& tokens, int index, Token::Category type );
+			bool isTailCall( std::vector<Token>& tokens, int start, int end );
 
 			std::vector<byte> assembleStream( std::vector<Token>& tokens, int start, int end, byte tags, bool embedded );
 			std::vector<byte> assemblePrimitive( Token );
@@ -1061,6 +1770,7 @@ namespace seq {
 			void optimizeIfApplicable( std::vector<Token>& tokens );
 			int extractHeaderData( std::vector<Token>& tokens, StringTable* arrayPtr );
 			StringTable* getTable();
+			unsigned int getSlot( const std::string& name );
 
 			void emit( seq::CompilerError error );
 			void fail( seq::CompilerError error );
@@ -1162,55 +1872,59 @@ constexpr long seq::util::whole( const double val ) noexcept {
 	return (long) val;
 }
 
-seq::type::Generic* seq::util::copyGeneric( const seq::type::Generic* entity ) {
+seq::type::Generic* seq::util::copyGeneric( const seq::type::Generic* entity, void* storage ) {
 
 	typedef seq::type::Generic G;
-	typedef G* (*copyFunc)( const G* );
+	typedef G* (*copyFunc)( const G*, void* );
+
+	// small value types are copied into given storage (if any), everything else goes on the heap
+#	define SQCPV( T ) [] (const G* entity, void* storage) -> G* { return storage ? new (storage) T( *(T*) entity ) : new T( *(T*) entity ); }
+#	define SQCPH( T ) [] (const G* entity, void* storage) -> G* { return new T( *(T*) entity ); }
+
 	static copyFunc copyFuncArr[ SEQ_MAX_DATA_TYPE ] = {
-			/* 1  Bool   */ [] (const G* entity) -> G* { return new seq::type::Bool( *(seq::type::Bool*) entity ); },
-			/* 2  Null   */ [] (const G* entity) -> G* { return new seq::type::Null( *(seq::type::Null*) entity ); },
-			/* 3  Number */ [] (const G* entity) -> G* { return new seq::type::Number( *(seq::type::Number*) entity ); },
-			/* 4  String */ [] (const G* entity) -> G* { return new seq::type::String( *(seq::type::String*) entity ); },
-			/* 5  Type   */ [] (const G* entity) -> G* { return new seq::type::Type( *(seq::type::Type*) entity ); },
-			/* 6  VMCall */ [] (const G* entity) -> G* { return new seq::type::VMCall( *(seq::type::VMCall*) entity ); },
-			/* 7  Arg    */ [] (const G* entity) -> G* { return new seq::type::Arg( *(seq::type::Arg*) entity ); },
-			/* 8  Func   */ [] (const G* entity) -> G* { return new seq::type::Function( *(seq::type::Function*) entity ); },
-			/* 9  Expr   */ [] (const G* entity) -> G* { return new seq::type::Expression( *(seq::type::Expression*) entity ); },
-			/* 10 Name   */ [] (const G* entity) -> G* { return new seq::type::Name( *(seq::type::Name*) entity ); },
-			/* 11 Flowc  */ [] (const G* entity) -> G* { return new seq::type::Flowc( *(seq::type::Flowc*) entity ); },
-			/* 12 Stream */ [] (const G* entity) -> G* { return new seq::type::Stream( *(seq::type::Stream*) entity ); },
-			/* 13 Blob   */ [] (const G* entity) -> G* { return ((seq::type::Blob*) entity)->copy(); }
+			/* 1  Bool   */ SQCPV( seq::type::Bool ),
+			/* 2  Null   */ SQCPV( seq::type::Null ),
+			/* 3  Number */ SQCPV( seq::type::Number ),
+			/* 4  String */ SQCPH( seq::type::String ),
+			/* 5  Type   */ SQCPV( seq::type::Type ),
+			/* 6  VMCall */ SQCPV( seq::type::VMCall ),
+			/* 7  Arg    */ SQCPV( seq::type::Arg ),
+			/* 8  Func   */ SQCPH( seq::type::Function ),
+			/* 9  Expr   */ SQCPH( seq::type::Expression ),
+			/* 10 Name   */ SQCPH( seq::type::Name ),
+			/* 11 Flowc  */ SQCPH( seq::type::Flowc ),
+			/* 12 Stream */ SQCPH( seq::type::Stream ),
+			/* 13 Blob   */ [] (const G* entity, void* storage) -> G* { return ((seq::type::Blob*) entity)->copy(); }
 	};
 
+#	undef SQCPV
+#	undef SQCPH
+
 	// this may fail if given entity has incorrect DataType
-	return copyFuncArr[((seq::byte) entity->getDataType()) - 1]( entity );
+	return copyFuncArr[((seq::byte) entity->getDataType()) - 1]( entity, storage );
 
 }
 
 seq::Generic seq::util::numberCast( seq::Generic arg ) {
-	seq::type::Number* num = nullptr;
+	double num = 0;
 
 	switch( arg.getDataType() ) {
 
 		case seq::DataType::Number: return arg;
 
 		case seq::DataType::Bool:
-			if( arg.Bool().getBool() ) {
-				num = new seq::type::Number( false, 1 );
-			}else{
-				num = new seq::type::Number( false, 0 );
-			}
+			num = arg.Bool().getBool() ? 1 : 0;
 			break;
 
 		case seq::DataType::Null:
-			num = new seq::type::Number( false, 0 );
+			num = 0;
 			break;
 
 		case seq::DataType::String:
 			try {
-				num = new seq::type::Number( false, std::stod( arg.String().getString() ) );
+				num = std::stod( arg.String().getString() );
 			} catch (std::invalid_argument &err) {
-				num = new seq::type::Number( false, 0 );
+				num = 0;
 			}
 			break;
 
@@ -1219,7 +1933,7 @@ seq::Generic seq::util::numberCast( seq::Generic arg ) {
 		case seq::DataType::Func:
 		case seq::DataType::Blob:
 		case seq::DataType::Type:
-			num = new seq::type::Number( false, 1 );
+			num = 1;
 			break;
 
 		// invalid casts: (stream, name, expr, arg)
@@ -1227,7 +1941,7 @@ seq::Generic seq::util::numberCast( seq::Generic arg ) {
 
 	}
 
-	return seq::Generic( num );
+	return newNumber( num );
 }
 
 seq::Generic seq::util::boolCast( seq::Generic arg ) {
@@ -1304,6 +2018,274 @@ seq::Fraction seq::util::asFraction( const double value ) {
 	return seq::type::Number( false, value ).getFraction();
 }
 
+bool seq::util::naturalOperation( seq::ExprOperator op, int64_t a, int64_t b, int64_t& result ) noexcept {
+
+	// check for overflow using compiler builtins if available,
+	// otherwise always fallback to floating point arithmetic
+	switch( op ) {
+#		if defined( __GNUC__ )
+		case seq::ExprOperator::Multiplication: return !__builtin_mul_overflow( a, b, &result );
+		case seq::ExprOperator::Addition: return !__builtin_add_overflow( a, b, &result );
+		case seq::ExprOperator::Subtraction: return !__builtin_sub_overflow( a, b, &result );
+#		endif
+
+		case seq::ExprOperator::Division:
+			if( b != 0 && !( a == INT64_MIN && b == -1 ) && a % b == 0 ) {
+				result = a / b;
+				return true;
+			}
+			return false;
+
+		default: return false;
+	}
+
+}
+
+bool seq::util::packNumbers( seq::Stream& stream, std::vector<double>& values ) {
+
+	values.resize( stream.size() );
+
+	for( size_t i = 0; i < stream.size(); i ++ ) {
+		if( stream[i].getDataType() != seq::DataType::Number ) {
+			return false;
+		}
+
+		values[i] = stream[i].Number().getDouble();
+	}
+
+	return true;
+
+}
+
+// vector operations used by the batch kernels, 4 lanes with AVX and 2 lanes with SSE2
+#ifdef SEQ_SIMD
+#	ifdef __AVX__
+#		define SQVEC __m256d
+#		define SQWIDTH 4
+#		define SQLOAD( p ) _mm256_loadu_pd( p )
+#		define SQSTORE( p, v ) _mm256_storeu_pd( p, v )
+#		define SQSET( x ) _mm256_set1_pd( x )
+#		define SQADD( a, b ) _mm256_add_pd( a, b )
+#		define SQSUB( a, b ) _mm256_sub_pd( a, b )
+#		define SQMUL( a, b ) _mm256_mul_pd( a, b )
+#		define SQDIV( a, b ) _mm256_div_pd( a, b )
+#		define SQMIN( a, b ) _mm256_min_pd( a, b )
+#		define SQMAX( a, b ) _mm256_max_pd( a, b )
+#		define SQAND( a, b ) _mm256_and_pd( a, b )
+#		define SQANDN( a, b ) _mm256_andnot_pd( a, b )
+#		define SQOR( a, b ) _mm256_or_pd( a, b )
+#		define SQLT( a, b ) _mm256_cmp_pd( a, b, _CMP_LT_OQ )
+#		define SQNAN( a ) _mm256_cmp_pd( a, a, _CMP_UNORD_Q )
+#		define SQBITS( v ) _mm256_movemask_pd( v )
+#	else
+#		define SQVEC __m128d
+#		define SQWIDTH 2
+#		define SQLOAD( p ) _mm_loadu_pd( p )
+#		define SQSTORE( p, v ) _mm_storeu_pd( p, v )
+#		define SQSET( x ) _mm_set1_pd( x )
+#		define SQADD( a, b ) _mm_add_pd( a, b )
+#		define SQSUB( a, b ) _mm_sub_pd( a, b )
+#		define SQMUL( a, b ) _mm_mul_pd( a, b )
+#		define SQDIV( a, b ) _mm_div_pd( a, b )
+#		define SQMIN( a, b ) _mm_min_pd( a, b )
+#		define SQMAX( a, b ) _mm_max_pd( a, b )
+#		define SQAND( a, b ) _mm_and_pd( a, b )
+#		define SQANDN( a, b ) _mm_andnot_pd( a, b )
+#		define SQOR( a, b ) _mm_or_pd( a, b )
+#		define SQLT( a, b ) _mm_cmplt_pd( a, b )
+#		define SQNAN( a ) _mm_cmpunord_pd( a, a )
+#		define SQBITS( v ) _mm_movemask_pd( v )
+#	endif
+#endif
+
+void seq::util::batchOperation( seq::ExprOperator op, const double* a, const double* b, double* result, size_t count ) noexcept {
+
+	size_t i = 0;
+
+#	ifdef SEQ_SIMD
+#	define SQLOOP( vop, sop ) \
+		for( ; i + SQWIDTH <= count; i += SQWIDTH ) SQSTORE( result + i, vop( SQLOAD( a + i ), SQLOAD( b + i ) ) ); \
+		for( ; i < count; i ++ ) result[i] = a[i] sop b[i];
+#	else
+#	define SQLOOP( vop, sop ) \
+		for( ; i < count; i ++ ) result[i] = a[i] sop b[i];
+#	endif
+
+	switch( op ) {
+		case seq::ExprOperator::Multiplication: SQLOOP( SQMUL, * ); break;
+		case seq::ExprOperator::Division: SQLOOP( SQDIV, / ); break;
+		case seq::ExprOperator::Addition: SQLOOP( SQADD, + ); break;
+		case seq::ExprOperator::Subtraction: SQLOOP( SQSUB, - ); break;
+		default: break;
+	}
+
+#	undef SQLOOP
+
+}
+
+void seq::util::batchRange( double min, double max, const double* values, byte* mask, size_t count ) noexcept {
+
+	size_t i = 0;
+
+#	ifdef SEQ_SIMD
+	const SQVEC vmin = SQSET( min );
+	const SQVEC vmax = SQSET( max );
+
+	for( ; i + SQWIDTH <= count; i += SQWIDTH ) {
+		const SQVEC v = SQLOAD( values + i );
+		const int bits = SQBITS( SQAND( SQLT( vmin, v ), SQLT( v, vmax ) ) );
+
+		for( int j = 0; j < SQWIDTH; j ++ ) {
+			mask[i + j] |= ( bits >> j ) & 1;
+		}
+	}
+#	endif
+
+	for( ; i < count; i ++ ) {
+		mask[i] |= ( values[i] > min && values[i] < max );
+	}
+
+}
+
+void seq::util::batchAbs( double* values, size_t count ) noexcept {
+
+	size_t i = 0;
+
+#	ifdef SEQ_SIMD
+	const SQVEC sign = SQSET( -0.0 );
+
+	for( ; i + SQWIDTH <= count; i += SQWIDTH ) {
+		SQSTORE( values + i, SQANDN( sign, SQLOAD( values + i ) ) );
+	}
+#	endif
+
+	for( ; i < count; i ++ ) {
+		values[i] = std::abs( values[i] );
+	}
+
+}
+
+double seq::util::batchBound( const double* values, size_t count ) noexcept {
+
+	double bound = 0;
+	bool nan = false;
+	size_t i = 0;
+
+#	ifdef SEQ_SIMD
+	const SQVEC sign = SQSET( -0.0 );
+	SQVEC vbound = SQSET( 0 );
+	SQVEC vnan = SQSET( 0 );
+
+	for( ; i + SQWIDTH <= count; i += SQWIDTH ) {
+		const SQVEC v = SQLOAD( values + i );
+		vbound = SQMAX( vbound, SQANDN( sign, v ) );
+		vnan = SQOR( vnan, SQNAN( v ) );
+	}
+
+	double lanes[SQWIDTH];
+	SQSTORE( lanes, vbound );
+	for( int j = 0; j < SQWIDTH; j ++ ) bound = std::max( bound, lanes[j] );
+	nan = SQBITS( vnan ) != 0;
+#	endif
+
+	for( ; i < count; i ++ ) {
+		if( std::isnan( values[i] ) ) nan = true;
+		bound = std::max( bound, std::abs( values[i] ) );
+	}
+
+	// NaN isn't bounded by anything
+	return nan ? INFINITY : bound;
+
+}
+
+double seq::util::batchSum( const double* values, size_t count ) noexcept {
+
+	double sum = 0;
+	size_t i = 0;
+
+	// the additions are reordered, so the result can differ
+	// from the sequential sum unless all values are natural
+#	ifdef SEQ_SIMD
+	SQVEC vsum = SQSET( 0 );
+
+	for( ; i + SQWIDTH <= count; i += SQWIDTH ) {
+		vsum = SQADD( vsum, SQLOAD( values + i ) );
+	}
+
+	double lanes[SQWIDTH];
+	SQSTORE( lanes, vsum );
+	for( int j = 0; j < SQWIDTH; j ++ ) sum += lanes[j];
+#	endif
+
+	for( ; i < count; i ++ ) {
+		sum += values[i];
+	}
+
+	return sum;
+
+}
+
+// finds minimum (or maximum) of a non-empty array, NaNs are handled the same way as
+// by a sequential comparison, that is, ignored unless the first value is NaN
+#ifdef SEQ_SIMD
+#	define SQEXTREME( vop, cmp ) \
+		if( count == 0 || std::isnan( values[0] ) ) return count == 0 ? NAN : values[0]; \
+		SQVEC vacc = SQSET( values[0] ); \
+		SQVEC vnan = SQSET( 0 ); \
+		size_t i = 1; \
+		for( ; i + SQWIDTH <= count; i += SQWIDTH ) { \
+			const SQVEC v = SQLOAD( values + i ); \
+			vacc = vop( v, vacc ); \
+			vnan = SQOR( vnan, SQNAN( v ) ); \
+		} \
+		double acc = values[0]; \
+		if( SQBITS( vnan ) == 0 ) { \
+			double lanes[SQWIDTH]; \
+			SQSTORE( lanes, vacc ); \
+			for( int j = 0; j < SQWIDTH; j ++ ) if( lanes[j] cmp acc ) acc = lanes[j]; \
+		}else{ \
+			i = 1; \
+		} \
+		for( ; i < count; i ++ ) if( values[i] cmp acc ) acc = values[i]; \
+		return acc;
+#else
+#	define SQEXTREME( vop, cmp ) \
+		if( count == 0 ) return NAN; \
+		double acc = values[0]; \
+		for( size_t i = 1; i < count; i ++ ) if( values[i] cmp acc ) acc = values[i]; \
+		return acc;
+#endif
+
+double seq::util::batchMin( const double* values, size_t count ) noexcept {
+	SQEXTREME( SQMIN, < );
+}
+
+double seq::util::batchMax( const double* values, size_t count ) noexcept {
+	SQEXTREME( SQMAX, > );
+}
+
+#undef SQEXTREME
+
+#ifdef SEQ_SIMD
+#	undef SQVEC
+#	undef SQWIDTH
+#	undef SQLOAD
+#	undef SQSTORE
+#	undef SQSET
+#	undef SQADD
+#	undef SQSUB
+#	undef SQMUL
+#	undef SQDIV
+#	undef SQMIN
+#	undef SQMAX
+#	undef SQAND
+#	undef SQANDN
+#	undef SQOR
+#	undef SQLT
+#	undef SQNAN
+#	undef SQBITS
+#endif
+
 seq::DataType seq::util::toDataType( const std::string str ) {
 	if( str == "number" ) return seq::DataType::Number;
 	if( str == "bool" ) return seq::DataType::Bool;
@@ -1313,15 +2295,15 @@ seq::DataType seq::util::toDataType( const std::string str ) {
 }
 
 seq::Generic seq::util::newBool( bool value, bool anchor ) noexcept {
-	return seq::Generic( new seq::type::Bool( anchor, value ) );
+	return seq::Generic( seq::type::Bool( anchor, value ) );
 }
 
 seq::Generic seq::util::newNumber( double value, bool anchor ) noexcept {
-	return seq::Generic( new seq::type::Number( anchor, value ) );
+	return seq::Generic( seq::type::Number( anchor, value ) );
 }
 
 seq::Generic seq::util::newArg( byte value, bool anchor ) noexcept {
-	return seq::Generic( new seq::type::Arg( anchor, value ) );
+	return seq::Generic( seq::type::Arg( anchor, value ) );
 }
 
 seq::Generic seq::util::newString( const char* value, bool anchor ) noexcept {
@@ -1329,11 +2311,11 @@ seq::Generic seq::util::newString( const char* value, bool anchor ) noexcept {
 }
 
 seq::Generic seq::util::newType( DataType value, bool anchor ) noexcept {
-	return seq::Generic( new seq::type::Type( anchor, value ) );
+	return seq::Generic( seq::type::Type( anchor, value ) );
 }
 
 seq::Generic seq::util::newVMCall( type::VMCall::CallType value, bool anchor ) noexcept {
-	return seq::Generic( new seq::type::VMCall( anchor, value ) );
+	return seq::Generic( seq::type::VMCall( anchor, value ) );
 }
 
 seq::Generic seq::util::newFunction( BufferReader* reader, bool end, bool anchor ) noexcept {
@@ -1353,7 +2335,7 @@ seq::Generic seq::util::newStream( byte tags, BufferReader* reader, bool anchor
 }
 
 seq::Generic seq::util::newNull( bool anchor ) noexcept {
-	return seq::Generic( new seq::type::Null( anchor ) );
+	return seq::Generic( seq::type::Null( anchor ) );
 }
 
 int seq::util::insertUnique( seq::StringTable* table, std::string entry ) {
@@ -1473,8 +2455,14 @@ void seq::BufferWriter::putCall( bool anchor, type::VMCall::CallType type ) {
 	this->putByte( (byte) type );
 }
 
-void seq::BufferWriter::putName( bool anchor, bool define, const char* name ) {
-	this->putOpcode( anchor, (define ? seq::Opcode::DEF : seq::Opcode::VAR) );
+void seq::BufferWriter::putName( bool anchor, bool define, const char* name, unsigned int slot ) {
+	if( slot == SEQ_NO_SLOT ) {
+		this->putOpcode( anchor, (define ? seq::Opcode::DEF : seq::Opcode::VAR) );
+	}else{
+		this->putOpcode( anchor, (define ? seq::Opcode::SDF : seq::Opcode::SVR) );
+		this->putUnsigned( slot );
+	}
+
 	this->putString( name );
 }
 
@@ -1659,7 +2647,23 @@ seq::FileHeader& seq::FileHeader::operator= ( FileHeader&& header ) noexcept {
 	return *this;
 }
 
-seq::type::Generic::Generic( const DataType _type, bool _anchor ): type( _type ), anchor( _anchor ) {}
+seq::type::Generic::Generic( const DataType _type, bool _anchor ): type( _type ), anchor( _anchor ), refs( 1 ) {}
+
+void* seq::type::Generic::operator new( size_t size ) {
+	return seq::Pool::allocate( size );
+}
+
+void* seq::type::Generic::operator new( size_t size, void* ptr ) noexcept {
+	return ptr;
+}
+
+void seq::type::Generic::operator delete( void* ptr, size_t size ) noexcept {
+	seq::Pool::release( ptr, size );
+}
+
+void seq::type::Generic::operator delete( void* ptr, void* place ) noexcept {}
+
+seq::type::Generic::Generic( const seq::type::Generic& generic ): type( generic.type ), anchor( generic.anchor ), refs( 1 ) {}
 
 bool seq::type::Generic::getAnchor() const noexcept {
 	return this->anchor;
@@ -1685,26 +2689,51 @@ byte seq::type::Arg::getLevel() {
 	return this->level;
 }
 
-seq::type::Number::Number( bool _anchor, double _value ): seq::type::Generic( seq::DataType::Number, _anchor ), value( _value ) {}
+seq::type::Number::Number( bool _anchor, double _value ): seq::type::Generic( seq::DataType::Number, _anchor ) {
+
+	// check the range first, as casting larger values is undefined
+	this->natural = _value >= (double) INT64_MIN && _value < (double) INT64_MAX && (double) (int64_t) _value == _value;
+
+	if( this->natural ) {
+		this->integer = (int64_t) _value;
+	}else{
+		this->value = _value;
+	}
+
+}
+
+seq::type::Number::Number( bool _anchor, int64_t numerator, int64_t denominator ): seq::type::Number( _anchor, (double) numerator / denominator ) {
 
-seq::type::Number::Number( bool _anchor, long numerator, long denominator ): seq::type::Generic( seq::DataType::Number, _anchor ), value( (double) numerator / denominator ) {};
+	// the value was possibly rounded by the conversion
+	if( denominator == 1 ) {
+		this->natural = true;
+		this->integer = numerator;
+	}
+
+}
 
 double seq::type::Number::getDouble() {
-	return this->value;
+	return this->natural ? (double) this->integer : this->value;
 }
 
-long seq::type::Number::getLong() {
-	return trunc( this->value );
+int64_t seq::type::Number::getLong() {
+	return this->natural ? this->integer : (int64_t) trunc( this->value );
 }
 
 bool seq::type::Number::isNatural() {
-	return this->getLong() == this->value;
+	return this->natural;
 }
 
 const seq::Fraction seq::type::Number::getFraction() {
 
-	long sign = ( this->value < 0 ) ? -1 : 1;
-	double number = std::abs( this->value );
+	// fractions use long, which can be narrower than naturals
+	if( this->natural && this->integer >= LONG_MIN && this->integer <= LONG_MAX ) {
+		return seq::Fraction{ (long) this->integer, 1 };
+	}
+
+	const double value = this->getDouble();
+	long sign = ( value < 0 ) ? -1 : 1;
+	double number = std::abs( value );
 	double whole = std::trunc( number );
 	double decimal = ( number - whole );
 	unsigned long long multiplier = 1;
@@ -1745,6 +2774,8 @@ byte seq::type::Number::sizeOf( unsigned long value ) {
 
 seq::type::String::String( bool _anchor, const char* _value ): seq::type::Generic( seq::DataType::String, _anchor ), value( _value ) {}
 
+seq::type::String::String( bool _anchor, std::string&& _value ): seq::type::Generic( seq::DataType::String, _anchor ), value( std::move( _value ) ) {}
+
 std::string& seq::type::String::getString() {
 	return this->value;
 }
@@ -1761,7 +2792,7 @@ seq::type::VMCall::CallType seq::type::VMCall::getCall() {
 	return this->value;
 }
 
-seq::type::Name::Name( bool _anchor, bool _define, std::string _name ): seq::type::Generic( seq::DataType::Name, _anchor ), define( _define ), name( _name ) {}
+seq::type::Name::Name( bool _anchor, bool _define, std::string _name, unsigned int _slot, const byte* _origin ): seq::type::Generic( seq::DataType::Name, _anchor ), define( _define ), slot( _slot ), origin( _origin ), name( std::move( _name ) ) {}
 
 bool seq::type::Name::getDefine() {
 	return this->define;
@@ -1771,6 +2802,14 @@ std::string& seq::type::Name::getName() {
 	return this->name;
 }
 
+unsigned int seq::type::Name::getSlot() {
+	return this->slot;
+}
+
+const byte* seq::type::Name::getOrigin() {
+	return this->origin;
+}
+
 seq::type::Function::Function( bool _anchor, seq::BufferReader* _reader, bool _end ): seq::type::Generic( seq::DataType::Func, _anchor ), reader( _reader ), end( _end ) {}
 
 seq::type::Function::Function( const seq::type::Function& func ): seq::type::Generic( seq::DataType::Func, func.anchor ), reader( new seq::BufferReader( *(func.reader) ) ), end( func.end ) {}
@@ -1822,7 +2861,7 @@ bool seq::type::Stream::matchesTags( byte _tags ) {
 	if( _tags & SEQ_TAG_END ) return this->tags & SEQ_TAG_END;
 
 	// stream don't have any tags
-	if( this->tags == 0 ) return true;
+	if( ( this->tags & ~SEQ_TAG_TAIL ) == 0 ) return true;
 
 	 // check last & first tag
 	if( this->tags & SEQ_TAG_FIRST ) return _tags & SEQ_TAG_FIRST;
@@ -1834,6 +2873,10 @@ bool seq::type::Stream::matchesTags( byte _tags ) {
 	throw seq::InternalError( "Invalid Tag!" );
 }
 
+bool seq::type::Stream::isTail() {
+	return this->tags & SEQ_TAG_TAIL;
+}
+
 byte seq::type::Stream::getTags() {
 	return this->tags;
 }
@@ -1854,9 +2897,9 @@ seq::type::Blob* seq::type::Blob::copy() {
 	return new seq::type::Blob( *this );
 }
 
-seq::type::Flowc::Flowc( bool _anchor, const std::vector< seq::FlowCondition* > _blocks ): seq::type::Generic( seq::DataType::Flowc, _anchor ), conditions( _blocks ) {}
+seq::type::Flowc::Flowc( bool _anchor, const std::vector< seq::FlowCondition* > _blocks ): seq::type::Generic( seq::DataType::Flowc, _anchor ), conditions( _blocks ), matcher( _blocks ) {}
 
-seq::type::Flowc::Flowc( const seq::type::Flowc& flowc ): seq::type::Generic( seq::DataType::Flowc, flowc.anchor ), conditions( seq::util::copyFlowConditions( flowc.conditions ) ) {}
+seq::type::Flowc::Flowc( const seq::type::Flowc& flowc ): seq::type::Generic( seq::DataType::Flowc, flowc.anchor ), conditions( seq::util::copyFlowConditions( flowc.conditions ) ), matcher( flowc.matcher ) {}
 
 seq::type::Flowc::~Flowc() {
 	for( const auto& fc : this->conditions ) delete fc;
@@ -1866,55 +2909,135 @@ const std::vector< seq::FlowCondition* >& seq::type::Flowc::getConditions() {
 	return this->conditions;
 }
 
+const seq::FlowMatcher& seq::type::Flowc::getMatcher() {
+	return this->matcher;
+}
+
 seq::Generic::Generic() {
-	this->generic = new seq::type::Null( false );
+	this->generic = new (this->storage) seq::type::Null( false );
 }
 
 seq::Generic::Generic( seq::type::Generic* _generic ) {
 	this->generic = _generic;
+	if( _generic != nullptr ) this->anchor = _generic->getAnchor();
+}
+
+seq::Generic::Generic( const seq::type::Generic& value ) {
+	this->generic = seq::util::copyGeneric( &value, this->storage );
+	if( !this->isInline() ) this->anchor = value.getAnchor();
 }
 
 seq::Generic::Generic( const seq::Generic& _generic ) {
-	this->generic = seq::util::copyGeneric( _generic.generic );
+	this->share( _generic );
 }
 
-seq::Generic::Generic( seq::Generic&& _generic ) {
-	this->generic = std::move( _generic.generic );
-	_generic.generic = nullptr;
+seq::Generic::Generic( seq::Generic&& _generic ) noexcept {
+	if( _generic.isInline() ) {
+		this->copyInline( _generic.generic );
+	}else{
+		this->generic = _generic.generic;
+		this->anchor = _generic.generic != nullptr && _generic.anchor;
+		_generic.generic = nullptr;
+	}
 }
 
 seq::Generic::~Generic() {
-	if( this->generic != nullptr ) delete this->generic;
+	this->release();
 }
 
 seq::Generic& seq::Generic::operator= ( const Generic& generic ) {
 	if( this != &generic ) {
-		seq::type::Generic* g = seq::util::copyGeneric( generic.generic );
-		delete this->generic;
-		this->generic = g;
+		this->release();
+		this->share( generic );
 	}
 	return *this;
 }
 
 seq::Generic& seq::Generic::operator= ( Generic&& generic ) noexcept {
 	if( this != &generic ) {
-		delete this->generic;
-		this->generic = generic.generic;
-		generic.generic = nullptr;
+		this->release();
+
+		if( generic.isInline() ) {
+			this->copyInline( generic.generic );
+		}else{
+			this->generic = generic.generic;
+			this->anchor = generic.generic != nullptr && generic.anchor;
+			generic.generic = nullptr;
+		}
 	}
 	return *this;
 }
 
-seq::DataType seq::Generic::getDataType() const noexcept {
-	return this->generic->getDataType();
+bool seq::Generic::isInline() const noexcept {
+	return this->generic == (const seq::type::Generic*) this->storage;
+}
+
+void seq::Generic::release() noexcept {
+	// inline values own no resources, so their destructors are skipped
+	if( !this->isInline() && this->generic != nullptr ) {
+		if( this->generic->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1 ) delete this->generic;
+	}
+}
+
+void seq::Generic::share( const seq::Generic& _generic ) {
+
+	if( _generic.isInline() ) {
+		this->copyInline( _generic.generic );
+		return;
+	}
+
+	this->anchor = _generic.generic != nullptr && _generic.anchor;
+
+	// blobs are user defined and can be mutable, so those are always copied
+	if( _generic.generic == nullptr || _generic.generic->getDataType() != seq::DataType::Blob ) {
+		this->generic = _generic.generic;
+		if( this->generic != nullptr ) this->generic->refs.fetch_add( 1, std::memory_order_relaxed );
+	}else{
+		this->generic = seq::util::copyGeneric( _generic.generic );
+		this->generic->setAnchor( this->anchor );
+	}
+
+}
+
+void seq::Generic::copyInline( const seq::type::Generic* value ) noexcept {
+
+	// inline values are polymorphic, so those are copy constructed in place, the types are
+	// listed here instead of using util::copyGeneric so that the copies get inlined, this
+	// matters as it happens each time a stream is shifted, numbers are the most common
+	const seq::DataType type = value->getDataType();
+
+	if( type == seq::DataType::Number ) {
+		this->generic = new (this->storage) seq::type::Number( *(const seq::type::Number*) value );
+		return;
+	}
+
+	switch( type ) {
+		case seq::DataType::Bool: this->generic = new (this->storage) seq::type::Bool( *(const seq::type::Bool*) value ); break;
+		case seq::DataType::Type: this->generic = new (this->storage) seq::type::Type( *(const seq::type::Type*) value ); break;
+		case seq::DataType::VMCall: this->generic = new (this->storage) seq::type::VMCall( *(const seq::type::VMCall*) value ); break;
+		case seq::DataType::Arg: this->generic = new (this->storage) seq::type::Arg( *(const seq::type::Arg*) value ); break;
+		default: this->generic = new (this->storage) seq::type::Null( *(const seq::type::Null*) value ); break;
+	}
+
+}
+
+seq::DataType seq::Generic::getDataType() const noexcept {
+	return this->generic->getDataType();
 }
 
 bool seq::Generic::getAnchor() const noexcept {
-	return this->generic->getAnchor();
+	return this->isInline() ? this->generic->getAnchor() : this->anchor;
 }
 
 void seq::Generic::setAnchor( bool anchor ) noexcept {
-	return this->generic->setAnchor( anchor );
+
+	if( this->isInline() ) {
+		return this->generic->setAnchor( anchor );
+	}
+
+	// shared values are left untouched, their copies keep the anchor they were created with
+	this->anchor = anchor;
+	if( this->generic->refs.load( std::memory_order_acquire ) == 1 ) this->generic->setAnchor( anchor );
 }
 
 seq::type::Generic* seq::Generic::getRaw() {
@@ -1973,6 +3096,271 @@ seq::type::Bool& seq::Generic::Bool() {
 	return *(static_cast<seq::type::Bool*>(this->generic));
 }
 
+seq::Stream::Stream() noexcept: elements( (seq::Generic*) this->storage ), count( 0 ), limit( SEQ_STREAM_INLINE ) {}
+
+seq::Stream::Stream( std::initializer_list<seq::Generic> list ): Stream() {
+	this->reserve( list.size() );
+	for( const seq::Generic& value : list ) new (this->elements + this->count ++) seq::Generic( value );
+}
+
+seq::Stream::Stream( size_t count, const seq::Generic& value ): Stream() {
+	this->reserve( count );
+	while( this->count < count ) new (this->elements + this->count ++) seq::Generic( value );
+}
+
+seq::Stream::Stream( const seq::Stream& stream ): Stream() {
+	this->reserve( stream.count );
+	for( const seq::Generic& value : stream ) new (this->elements + this->count ++) seq::Generic( value );
+}
+
+seq::Stream::Stream( seq::Stream&& stream ) noexcept: Stream() {
+	*this = std::move( stream );
+}
+
+seq::Stream::~Stream() {
+	this->clear();
+	if( !this->isInline() ) ::operator delete( this->elements );
+}
+
+seq::Stream& seq::Stream::operator= ( const seq::Stream& stream ) {
+	if( this != &stream ) {
+		this->clear();
+		this->reserve( stream.count );
+		for( const seq::Generic& value : stream ) new (this->elements + this->count ++) seq::Generic( value );
+	}
+	return *this;
+}
+
+seq::Stream& seq::Stream::operator= ( seq::Stream&& stream ) noexcept {
+	if( this != &stream ) {
+		this->clear();
+
+		if( stream.isInline() ) {
+
+			// inline elements can't be stolen, but always fit in the
+			// buffer (inline or not) of this stream, so those are moved one by one
+			for( seq::Generic& value : stream ) new (this->elements + this->count ++) seq::Generic( std::move( value ) );
+			stream.clear();
+
+		}else{
+
+			if( !this->isInline() ) ::operator delete( this->elements );
+			this->elements = stream.elements;
+			this->count = stream.count;
+			this->limit = stream.limit;
+
+			stream.elements = (seq::Generic*) stream.storage;
+			stream.count = 0;
+			stream.limit = SEQ_STREAM_INLINE;
+
+		}
+	}
+	return *this;
+}
+
+seq::Stream& seq::Stream::operator= ( std::initializer_list<seq::Generic> list ) {
+	this->assign( list.begin(), list.end() );
+	return *this;
+}
+
+size_t seq::Stream::size() const noexcept {
+	return this->count;
+}
+
+size_t seq::Stream::capacity() const noexcept {
+	return this->limit;
+}
+
+bool seq::Stream::empty() const noexcept {
+	return this->count == 0;
+}
+
+bool seq::Stream::isInline() const noexcept {
+	return this->elements == (const seq::Generic*) this->storage;
+}
+
+seq::Generic& seq::Stream::operator[] ( size_t index ) noexcept {
+	return this->elements[index];
+}
+
+const seq::Generic& seq::Stream::operator[] ( size_t index ) const noexcept {
+	return this->elements[index];
+}
+
+seq::Generic& seq::Stream::at( size_t index ) {
+	if( index >= this->count ) throw std::out_of_range( "Stream index out of range!" );
+	return this->elements[index];
+}
+
+const seq::Generic& seq::Stream::at( size_t index ) const {
+	if( index >= this->count ) throw std::out_of_range( "Stream index out of range!" );
+	return this->elements[index];
+}
+
+seq::Generic& seq::Stream::front() noexcept {
+	return this->elements[0];
+}
+
+const seq::Generic& seq::Stream::front() const noexcept {
+	return this->elements[0];
+}
+
+seq::Generic& seq::Stream::back() noexcept {
+	return this->elements[this->count - 1];
+}
+
+const seq::Generic& seq::Stream::back() const noexcept {
+	return this->elements[this->count - 1];
+}
+
+seq::Generic* seq::Stream::data() noexcept {
+	return this->elements;
+}
+
+const seq::Generic* seq::Stream::data() const noexcept {
+	return this->elements;
+}
+
+seq::Stream::iterator seq::Stream::begin() noexcept {
+	return this->elements;
+}
+
+seq::Stream::iterator seq::Stream::end() noexcept {
+	return this->elements + this->count;
+}
+
+seq::Stream::const_iterator seq::Stream::begin() const noexcept {
+	return this->elements;
+}
+
+seq::Stream::const_iterator seq::Stream::end() const noexcept {
+	return this->elements + this->count;
+}
+
+seq::Stream::reverse_iterator seq::Stream::rbegin() noexcept {
+	return reverse_iterator( this->end() );
+}
+
+seq::Stream::reverse_iterator seq::Stream::rend() noexcept {
+	return reverse_iterator( this->begin() );
+}
+
+seq::Stream::const_reverse_iterator seq::Stream::rbegin() const noexcept {
+	return const_reverse_iterator( this->end() );
+}
+
+seq::Stream::const_reverse_iterator seq::Stream::rend() const noexcept {
+	return const_reverse_iterator( this->begin() );
+}
+
+void seq::Stream::reserve( size_t count ) {
+	if( count > this->limit ) this->grow( count );
+}
+
+void seq::Stream::resize( size_t count ) {
+	if( count < this->count ) {
+		this->erase( this->elements + count, this->end() );
+	}else{
+		this->reserve( count );
+		while( this->count < count ) new (this->elements + this->count ++) seq::Generic();
+	}
+}
+
+void seq::Stream::clear() noexcept {
+	for( size_t i = 0; i < this->count; i ++ ) this->elements[i].~Generic();
+	this->count = 0;
+}
+
+void seq::Stream::swap( seq::Stream& stream ) noexcept {
+	seq::Stream tmp( std::move( stream ) );
+	stream = std::move( *this );
+	*this = std::move( tmp );
+}
+
+void seq::Stream::push_back( const seq::Generic& value ) {
+	if( this->count == this->limit ) {
+		// the value can be an element of this stream, so it's copied before growing
+		seq::Generic copy( value );
+		this->grow( this->count + 1 );
+		new (this->elements + this->count ++) seq::Generic( std::move( copy ) );
+	}else{
+		new (this->elements + this->count ++) seq::Generic( value );
+	}
+}
+
+void seq::Stream::push_back( seq::Generic&& value ) {
+	if( this->count == this->limit ) {
+		seq::Generic copy( std::move( value ) );
+		this->grow( this->count + 1 );
+		new (this->elements + this->count ++) seq::Generic( std::move( copy ) );
+	}else{
+		new (this->elements + this->count ++) seq::Generic( std::move( value ) );
+	}
+}
+
+void seq::Stream::pop_back() noexcept {
+	this->elements[ -- this->count ].~Generic();
+}
+
+seq::Stream::iterator seq::Stream::insert( const_iterator pos, const seq::Generic& value ) {
+	seq::Generic copy( value );
+	seq::Generic* gap = this->open( pos - this->elements, 1 );
+	*gap = std::move( copy );
+	return gap;
+}
+
+seq::Stream::iterator seq::Stream::insert( const_iterator pos, seq::Generic&& value ) {
+	seq::Generic copy( std::move( value ) );
+	seq::Generic* gap = this->open( pos - this->elements, 1 );
+	*gap = std::move( copy );
+	return gap;
+}
+
+seq::Stream::iterator seq::Stream::erase( const_iterator pos ) {
+	return this->erase( pos, pos + 1 );
+}
+
+seq::Stream::iterator seq::Stream::erase( const_iterator first, const_iterator last ) {
+	seq::Generic* start = this->elements + ( first - this->elements );
+	const size_t length = last - first;
+
+	if( length != 0 ) {
+		std::move( start + length, this->end(), start );
+		for( size_t i = this->count - length; i < this->count; i ++ ) this->elements[i].~Generic();
+		this->count -= length;
+	}
+
+	return start;
+}
+
+void seq::Stream::grow( size_t count ) {
+	const size_t limit = std::max( count, this->limit * 2 );
+	seq::Generic* elements = (seq::Generic*) ::operator new( limit * sizeof( seq::Generic ) );
+
+	// generics can point into themselves (see seq::Generic::isInline)
+	// so those need to be moved using the move constructor, not memcpy
+	for( size_t i = 0; i < this->count; i ++ ) {
+		new (elements + i) seq::Generic( std::move( this->elements[i] ) );
+		this->elements[i].~Generic();
+	}
+
+	if( !this->isInline() ) ::operator delete( this->elements );
+	this->elements = elements;
+	this->limit = limit;
+}
+
+seq::Generic* seq::Stream::open( size_t offset, size_t count ) {
+	if( this->count + count > this->limit ) this->grow( this->count + count );
+
+	// construct the new tail, and shift the elements after the offset into it,
+	// leaving a gap of (moved-from) generics to be assigned by the caller
+	for( size_t i = 0; i < count; i ++ ) new (this->elements + this->count + i) seq::Generic();
+	std::move_backward( this->elements + offset, this->end(), this->end() + count );
+	this->count += count;
+
+	return this->elements + offset;
+}
+
 seq::InternalError::InternalError( const std::string& error ) {
 	this->error = "Internal Sequensa error occured: " + error;
 }
@@ -2048,19 +3436,19 @@ void seq::ByteBuffer::setStringTable( StringTable* table ) {
 	this->table = table;
 }
 
-seq::StringTable* seq::ByteBuffer::getStringTable() {
+seq::StringTable* seq::ByteBuffer::getStringTable() const {
 	return table;
 }
 
-long seq::ByteBuffer::size() {
+long seq::ByteBuffer::size() const {
 	return length;
 }
 
-seq::BufferReader seq::ByteBuffer::getReader() {
+seq::BufferReader seq::ByteBuffer::getReader() const {
 	return seq::BufferReader( this->pointer, 0, this->length - 1, table );
 }
 
-seq::BufferReader seq::ByteBuffer::getReader( long first, long last ) {
+seq::BufferReader seq::ByteBuffer::getReader( long first, long last ) const {
 	if( first < 0 || last > (this->length - 1) || first > last ) throw seq::InternalError( "Invalid BufferReader range!" );
 	return seq::BufferReader( this->pointer, first, last, table );
 }
@@ -2218,25 +3606,25 @@ seq::TokenReader::TokenReader( seq::BufferReader& reader ): reader( reader ) {
 
 	typedef seq::type::Generic G;
 	typedef seq::TokenReader TR;
-	typedef G* (*loadFunc)( TR* );
+	typedef seq::Generic (*loadFunc)( TR* );
 
 	static loadFunc loadFuncArr[ SEQ_MAX_DATA_TYPE ] = {
-		/* 1  Bool   */ [] (TR* tr) -> G* { return tr->loadBool(); },
-		/* 2  Null   */ [] (TR* tr) -> G* { return new seq::type::Null( tr->anchor ); },
-		/* 3  Number */ [] (TR* tr) -> G* { return tr->loadNumber(); },
-		/* 4  String */ [] (TR* tr) -> G* { return tr->loadString(); },
-		/* 5  Type   */ [] (TR* tr) -> G* { return tr->loadType(); },
-		/* 6  VMCall */ [] (TR* tr) -> G* { return tr->loadCall(); },
-		/* 7  Arg    */ [] (TR* tr) -> G* { return tr->loadArg(); },
-		/* 8  Func   */ [] (TR* tr) -> G* { return tr->loadFunc(); },
-		/* 9  Expr   */ [] (TR* tr) -> G* { return tr->loadExpr(); },
-		/* 10 Name   */ [] (TR* tr) -> G* { return tr->loadName(); },
-		/* 11 Flowc  */ [] (TR* tr) -> G* { return tr->loadFlowc(); },
-		/* 12 Stream */ [] (TR* tr) -> G* { return tr->loadStream(); },
-		/* 13 Blob   */ [] (TR* tr) -> G* { return nullptr; }
+		/* 1  Bool   */ [] (TR* tr) -> seq::Generic { return seq::Generic( tr->loadBool() ); },
+		/* 2  Null   */ [] (TR* tr) -> seq::Generic { return seq::Generic( seq::type::Null( tr->anchor ) ); },
+		/* 3  Number */ [] (TR* tr) -> seq::Generic { return seq::Generic( tr->loadNumber() ); },
+		/* 4  String */ [] (TR* tr) -> seq::Generic { return seq::Generic( (G*) tr->loadString() ); },
+		/* 5  Type   */ [] (TR* tr) -> seq::Generic { return seq::Generic( tr->loadType() ); },
+		/* 6  VMCall */ [] (TR* tr) -> seq::Generic { return seq::Generic( tr->loadCall() ); },
+		/* 7  Arg    */ [] (TR* tr) -> seq::Generic { return seq::Generic( tr->loadArg() ); },
+		/* 8  Func   */ [] (TR* tr) -> seq::Generic { return seq::Generic( (G*) tr->loadFunc() ); },
+		/* 9  Expr   */ [] (TR* tr) -> seq::Generic { return seq::Generic( (G*) tr->loadExpr() ); },
+		/* 10 Name   */ [] (TR* tr) -> seq::Generic { return seq::Generic( (G*) tr->loadName() ); },
+		/* 11 Flowc  */ [] (TR* tr) -> seq::Generic { return seq::Generic( (G*) tr->loadFlowc() ); },
+		/* 12 Stream */ [] (TR* tr) -> seq::Generic { return seq::Generic( (G*) tr->loadStream() ); },
+		/* 13 Blob   */ [] (TR* tr) -> seq::Generic { return seq::Generic( (G*) nullptr ); }
 	};
 
-	this->generic = seq::Generic( loadFuncArr[((seq::byte) this->type) - 1]( this ) );
+	this->generic = loadFuncArr[((seq::byte) this->type) - 1]( this );
 }
 
 seq::Generic& seq::TokenReader::getGeneric() {
@@ -2262,7 +3650,9 @@ seq::DataType seq::TokenReader::getDataType( byte header ) {
 		/* 14 FLC */ seq::DataType::Flowc,
 		/* 15 SSL */ seq::DataType::Stream,
 		/* 16 FNE */ seq::DataType::Func,
-		/* 17 TEX */ seq::DataType::Expr
+		/* 17 TEX */ seq::DataType::Expr,
+		/* 18 SVR */ seq::DataType::Name,
+		/* 19 SDF */ seq::DataType::Name
 	};
 
 	if( header >= SEQ_MIN_OPCODE && header <= SEQ_MAX_OPCODE ) {
@@ -2280,11 +3670,11 @@ bool seq::TokenReader::isAnchored() {
 	return this->anchor;
 }
 
-seq::type::Bool* seq::TokenReader::loadBool() {
-	return new seq::type::Bool( this->anchor, this->header == (byte) seq::Opcode::BLT );
+seq::type::Bool seq::TokenReader::loadBool() {
+	return seq::type::Bool( this->anchor, this->header == (byte) seq::Opcode::BLT );
 }
 
-seq::type::Number* seq::TokenReader::loadNumber() {
+seq::type::Number seq::TokenReader::loadNumber() {
 
 	byte head = this->reader.nextByte();
 
@@ -2313,41 +3703,50 @@ seq::type::Number* seq::TokenReader::loadNumber() {
 		// otherwise nothing is done. (there is no sign bit that needs to be moved)
 		// Warning: Denominator is considered unsigned
 		unsigned long sign = (1ul << ((unsigned long) a * 8ul - 1ul));
-		return new seq::type::Number( this->anchor, (n & sign) ? -(long)(sign ^ n) : n, d );
+		return seq::type::Number( this->anchor, (n & sign) ? -(long)(sign ^ n) : n, d );
 
 	}else{
 
-		return new seq::type::Number( this->anchor, (long) (signed char) head, 1 );
+		return seq::type::Number( this->anchor, (long) (signed char) head, 1 );
 
 	}
 }
 
-seq::type::Arg* seq::TokenReader::loadArg() {
-	return new seq::type::Arg( this->anchor, this->reader.nextByte() );
+seq::type::Arg seq::TokenReader::loadArg() {
+	return seq::type::Arg( this->anchor, this->reader.nextByte() );
 }
 
 seq::type::String* seq::TokenReader::loadString() {
 	std::string str;
 	this->reader.nextString(&str);
-	return new seq::type::String( this->isAnchored(), str.c_str() );
+	return new seq::type::String( this->isAnchored(), std::move( str ) );
 }
 
-seq::type::Type* seq::TokenReader::loadType() {
+seq::type::Type seq::TokenReader::loadType() {
 	byte b = this->reader.nextByte();
 	if( b > SEQ_MAX_DATA_TYPE || b < SEQ_MIN_DATA_TYPE ) throw seq::InternalError( "Invalid data type!" );
-	return new seq::type::Type( this->anchor, (seq::DataType) b );
+	return seq::type::Type( this->anchor, (seq::DataType) b );
 }
 
-seq::type::VMCall* seq::TokenReader::loadCall() {
+seq::type::VMCall seq::TokenReader::loadCall() {
 	byte b = this->reader.nextByte();
 	if( b > SEQ_MAX_CALL_TYPE && b < SEQ_MIN_CALL_TYPE ) throw seq::InternalError( "Invalid call type!" );
-	return new seq::type::VMCall( this->anchor, (seq::type::VMCall::CallType) b );
+	return seq::type::VMCall( this->anchor, (seq::type::VMCall::CallType) b );
 }
 
 seq::type::Name* seq::TokenReader::loadName() {
+	const byte* origin = this->reader.bytes();
+	unsigned int slot = SEQ_NO_SLOT;
+
+	if( this->header == (byte) seq::Opcode::SVR || this->header == (byte) seq::Opcode::SDF ) {
+		slot = this->reader.nextUnsigned();
+	}
+
 	std::string str;
 	this->reader.nextString(&str);
-	return new seq::type::Name( this->anchor, this->header == (byte) seq::Opcode::DEF, str );
+
+	bool define = ( this->header == (byte) seq::Opcode::DEF || this->header == (byte) seq::Opcode::SDF );
+	return new seq::type::Name( this->anchor, define, std::move( str ), slot, origin );
 }
 
 seq::type::Function* seq::TokenReader::loadFunc() {
@@ -2443,6 +3842,9 @@ seq::StackLevel::StackLevel( seq::Generic arg ) {
 seq::StackLevel::StackLevel( seq::StackLevel&& level ) {
 	this->arg = std::move( level.arg );
 	this->vars = std::move( level.vars );
+	this->index = std::move( level.index );
+	this->slots = std::move( level.slots );
+	this->defined = std::move( level.defined );
 }
 
 seq::Generic seq::StackLevel::getArg() {
@@ -2450,29 +3852,98 @@ seq::Generic seq::StackLevel::getArg() {
 }
 
 seq::Stream seq::StackLevel::getVar( std::string& name, bool anchor ) {
-	static seq::Stream ret;
-	auto& vars = this->vars.at( name );
+	seq::Stream ret;
+	seq::Stream* vars = this->findVar( name );
+	if( vars == nullptr ) throw seq::InternalError( "Undefined variable: '" + name + "'!" );
+	ret.reserve( vars->size() );
+
+	for( auto& g : *vars ) {
+		ret.push_back( g );
+		ret.back().setAnchor( anchor );
+	}
+
+	return ret;
+}
+
+bool seq::StackLevel::hasVar( std::string& name ) {
+	return !this->vars.empty() && this->findVar( name ) != nullptr;
+}
+
+void seq::StackLevel::setVar( std::string& name, seq::Stream&& value ) {
+	seq::Stream* vars = this->findVar( name );
+
+	if( vars != nullptr ) {
+		*vars = std::move( value );
+		return;
+	}
+
+	this->vars.emplace_back( name, std::move( value ) );
+
+	// build the index once the linear search gets too slow
+	if( this->vars.size() > SEQ_FLAT_VARS ) {
+		if( this->index.empty() ) {
+			for( size_t i = 0; i < this->vars.size(); i ++ ) this->index[ this->vars[i].first ] = i;
+		}else{
+			this->index[ name ] = this->vars.size() - 1;
+		}
+	}
+}
+
+seq::Stream* seq::StackLevel::findVar( const std::string& name ) {
+	if( this->vars.size() > SEQ_FLAT_VARS ) {
+		auto it = this->index.find( name );
+		return ( it == this->index.end() ) ? nullptr : &this->vars[ it->second ].second;
+	}
+
+	for( auto& var : this->vars ) {
+		if( var.first == name ) return &var.second;
+	}
+
+	return nullptr;
+}
+
+seq::Stream seq::StackLevel::getSlot( unsigned int slot, bool anchor ) {
+	seq::Stream ret;
+	auto& vars = this->slots[ slot ];
 	ret.reserve( vars.size() );
 
 	for( auto& g : vars ) {
-		seq::Generic ng( g );
-		ng.setAnchor( anchor );
-		ret.push_back( ng );
+		ret.push_back( g );
+		ret.back().setAnchor( anchor );
 	}
 
-	return std::move(ret);
+	return ret;
 }
 
-bool seq::StackLevel::hasVar( std::string& name ) {
-	return this->vars.count(name) != 0;
+bool seq::StackLevel::hasSlot( unsigned int slot ) {
+	return slot < this->defined.size() && this->defined[ slot ];
+}
+
+void seq::StackLevel::setSlot( unsigned int slot, seq::Stream&& value ) {
+	if( slot >= this->slots.size() ) {
+		this->slots.resize( slot + 1 );
+		this->defined.resize( slot + 1, false );
+	}
+
+	this->slots[ slot ] = std::move( value );
+	this->defined[ slot ] = true;
 }
 
-void seq::StackLevel::setVar( std::string& name, seq::Stream value ) {
-	this->vars[ name ] = value;
+bool seq::StackLevel::isEmpty() {
+	return this->vars.empty() && this->defined.empty();
 }
 
 void seq::StackLevel::setArg( seq::Generic _arg ) {
-	this->arg = _arg;
+	this->arg = std::move( _arg );
+}
+
+void seq::StackLevel::clear() {
+	// the values are released, but the storage is kept for reuse
+	this->arg = seq::Generic();
+	this->vars.clear();
+	this->index.clear();
+	this->slots.clear();
+	this->defined.clear();
 }
 
 seq::FlowCondition::FlowCondition( seq::FlowCondition::Type _type, seq::Generic _a, seq::Generic _b ): type( _type ), a( _a ), b( _b ) {}
@@ -2519,132 +3990,562 @@ bool seq::FlowCondition::validate( seq::Generic arg ) {
 	return false;
 }
 
-seq::CommandResult::CommandResult( seq::CommandResult::ResultType _stt, seq::Stream _acc ): stt( _stt ), acc( _acc ) {}
-
-seq::Executor::Executor( Executor* parent ) {
-	this->stack.push_back( seq::StackLevel() );
-	this->strictMath = false;
-	this->parent = parent;
-}
+seq::FlowMatcher::FlowMatcher( const std::vector<seq::FlowCondition*>& conditions ): types( 0 ), bools( 0 ) {
 
-seq::Executor::Executor(): Executor( nullptr ) {};
+	for( seq::FlowCondition* fc : conditions ) {
+		switch( fc->type ) {
 
-void seq::Executor::inject( std::string name, seq::type::Native native ) {
-	this->natives[ name ] = native;
-}
+			case seq::FlowCondition::Type::Type:
+				this->types |= 1u << (byte) fc->a.Type().getType();
+				break;
 
-void seq::Executor::define( std::string name, seq::Stream stream ) {
-	this->getTopLevel()->setVar( name, stream );
-}
+			case seq::FlowCondition::Type::Value:
+				switch( fc->a.getDataType() ) {
+					case seq::DataType::Null: this->types |= 1u << (byte) seq::DataType::Null; break;
+					case seq::DataType::Bool: this->bools |= fc->a.Bool().getBool() ? 2 : 1; break;
+					case seq::DataType::String: this->strings.insert( fc->a.String().getString() ); break;
 
-seq::StackLevel* seq::Executor::getLevel( int level ) {
-	try{
-		return &(this->stack.at( level ));
-	}catch( std::out_of_range& ex ) {
-		return nullptr;
-	}
-}
+					// NaN is not equal to anything, including itself
+					case seq::DataType::Number:
+						if( !std::isnan( fc->a.Number().getDouble() ) ) this->numbers.insert( fc->a.Number().getDouble() );
+						break;
 
-seq::StackLevel* seq::Executor::getTopLevel() {
-	return &(this->stack.back());
-}
+					default: break;
+				}
+				break;
 
-void seq::Executor::reset() {
-	this->natives.clear();
-}
+			case seq::FlowCondition::Type::Range: {
+					const double a = fc->a.Number().getDouble();
+					const double b = fc->b.Number().getDouble();
 
-std::string seq::Executor::getResultString() {
-	return seq::util::stringCast( this->getResult() ).String().getString();
-}
+					// empty ranges can't match anything
+					if( a < b ) this->ranges.emplace_back( a, b );
+				}
+				break;
 
-seq::Generic seq::Executor::getResult() {
-	if( this->result.size() > 0 ) {
-		return this->result.at(0);
-	}else{
-		return seq::util::newNull();
+		}
 	}
-}
 
-seq::Stream& seq::Executor::getResults() {
-	return this->result;
-}
+	std::sort( this->ranges.begin(), this->ranges.end() );
 
-void seq::Executor::setStrictMath( bool flag ) {
-	strictMath = flag;
-}
+	// merge overlapping ranges, ranges that only touch can't be merged
+	// as the shared bound doesn't belong to either one of them
+	size_t last = 0;
+	for( size_t i = 1; i < this->ranges.size(); i ++ ) {
+		if( this->ranges[i].first < this->ranges[last].second ) {
+			this->ranges[last].second = std::max( this->ranges[last].second, this->ranges[i].second );
+		}else{
+			this->ranges[++ last] = this->ranges[i];
+		}
+	}
 
-void seq::Executor::execute( seq::ByteBuffer bb, seq::Stream args, bool stack ) {
-	try{
-		seq::Stream exitStream = this->executeFunction( bb.getReader(), args, true, stack );
-		this->exit( exitStream, 0 );
-	}catch( seq::ExecutorInterrupt& ex ) {
-		// this->result set by the this->exit method
+	if( !this->ranges.empty() ) {
+		this->ranges.resize( last + 1 );
 	}
-}
 
-void seq::Executor::exit( seq::Stream& stream, byte code ) {
-	// stop program execution
-	this->result = stream;
-	throw seq::ExecutorInterrupt( code );
 }
 
-seq::Stream seq::Executor::executeFunction( seq::BufferReader fbr, seq::Stream& input_stream, bool end, bool stack ) {
+bool seq::FlowMatcher::validate( seq::Generic& arg ) const {
 
-	// push new stack into stack array
-	if( stack ) this->stack.push_back( seq::StackLevel() );
+	const seq::DataType type = arg.getDataType();
 
-	// accumulator of all returned entities
-	seq::Stream acc;
+	if( this->types & ( 1u << (byte) type ) ) {
+		return true;
+	}
 
-	// turn end flag into offset
-	int o = (end ? 0 : -1);
+	switch( type ) {
 
-	// execute scope for each input_stream element
-	for ( long i = 0; i <= (long) input_stream.size() + o; i ++ ) {
+		case seq::DataType::Bool:
+			return this->bools & ( arg.Bool().getBool() ? 2 : 1 );
 
-		const long size = input_stream.size();
-		const byte tags = seq::util::packTags( i, size );
-		seq::BufferReader br = fbr;
+		case seq::DataType::String:
+			return !this->strings.empty() && this->strings.count( arg.String().getString() );
 
-		// set current stack argument
-		this->getTopLevel()->setArg( (i == size) ? seq::Generic( new seq::type::Null( false ) ) : input_stream[i] );
+		case seq::DataType::Number: {
+				const double value = arg.Number().getDouble();
 
-		// iterate over function code
-		while( br.hasNext() ) {
+				if( !this->numbers.empty() && this->numbers.count( value ) ) {
+					return true;
+				}
 
-			// run next command
-			seq::TokenReader tk = br.next();
-			seq::CommandResult cr = this->executeCommand( &tk, tags );
+				// find the last range that starts below the value
+				auto it = std::lower_bound( this->ranges.begin(), this->ranges.end(), value, [] ( const std::pair<double, double>& range, double value ) {
+					return range.first < value;
+				} );
 
-			// check state
-			switch( cr.stt ) {
+				return it != this->ranges.begin() && value < ( -- it )->second;
+			}
 
-				case seq::CommandResult::ResultType::Return:
-					// insert returned data to function output stream
-					acc.insert(acc.end(), cr.acc.begin(), cr.acc.end());
-					break;
+		default:
+			return false;
 
-				case seq::CommandResult::ResultType::Break:
-					// exit scope
-					goto exit;
-					break;
+	}
 
-				case seq::CommandResult::ResultType::Exit:
-					// stop program execution (by throwing exception)
-					this->exit( cr.acc, 0 );
-					break;
+}
+
+void seq::FlowMatcher::validate( const double* values, byte* mask, size_t count ) const {
+
+	const bool any = this->types & ( 1u << (byte) seq::DataType::Number );
+	std::fill( mask, mask + count, any ? 1 : 0 );
+
+	if( any ) {
+		return;
+	}
+
+	for( auto& range : this->ranges ) {
+		seq::util::batchRange( range.first, range.second, values, mask, count );
+	}
+
+	if( !this->numbers.empty() ) {
+		for( size_t i = 0; i < count; i ++ ) {
+			if( !mask[i] && this->numbers.count( values[i] ) ) mask[i] = 1;
+		}
+	}
+
+}
+
+seq::Pool::Pool() noexcept: allocations( 0 ), releases( 0 ), chunks( 0 ) {
+	std::fill( this->lists, this->lists + SEQ_POOL_CLASSES, nullptr );
+}
+
+seq::Pool::~Pool() {
+
+	// the thread is exiting, hand all free blocks over to other threads,
+	// chunks are never freed as their blocks can still be used elsewhere
+	std::lock_guard<std::mutex> guard( lock() );
+	Block** global = shared();
+
+	for( size_t i = 0; i < SEQ_POOL_CLASSES; i ++ ) {
+		while( this->lists[i] != nullptr ) {
+			Block* block = this->lists[i];
+			this->lists[i] = block->next;
+			block->next = global[i];
+			global[i] = block;
+		}
+	}
+
+}
+
+seq::Pool* seq::Pool::local() noexcept {
+	static thread_local bool destroyed = false;
+	static thread_local struct Owner {
+		Pool pool;
+		~Owner() { destroyed = true; }
+	} owner;
+
+	// objects released after the pool was destroyed go to the shared lists
+	return destroyed ? nullptr : &owner.pool;
+}
+
+seq::Pool::Block** seq::Pool::shared() noexcept {
+	static Block* lists[SEQ_POOL_CLASSES] = {};
+	return lists;
+}
+
+std::mutex& seq::Pool::lock() noexcept {
+
+	// never destroyed, so that it can be used by exiting threads
+	static std::mutex* mutex = new std::mutex();
+	return *mutex;
+
+}
+
+seq::Pool::Block* seq::Pool::refill( size_t index, size_t size ) {
+
+	{
+		// try reusing blocks left by exited threads first
+		std::lock_guard<std::mutex> guard( lock() );
+		Block** global = shared();
+
+		if( global[index] != nullptr ) {
+			Block* list = global[index];
+			global[index] = nullptr;
+			return list;
+		}
+	}
+
+	// split new chunk into a list of blocks
+	byte* chunk = (byte*) ::operator new( SEQ_POOL_CHUNK );
+	Block* list = nullptr;
+
+	for( size_t offset = SEQ_POOL_CHUNK / size * size; offset != 0; offset -= size ) {
+		Block* block = (Block*) ( chunk + offset - size );
+		block->next = list;
+		list = block;
+	}
+
+	Pool* pool = local();
+	if( pool != nullptr ) pool->chunks ++;
+
+	return list;
+
+}
+
+void* seq::Pool::allocate( size_t size ) {
+
+	const size_t index = ( size - 1 ) / SEQ_POOL_STEP;
+
+	if( size == 0 || index >= SEQ_POOL_CLASSES ) {
+		return ::operator new( size );
+	}
+
+	Pool* pool = local();
+	Block* block;
+
+	if( pool == nullptr ) {
+		std::lock_guard<std::mutex> guard( lock() );
+		block = shared()[index];
+
+		if( block != nullptr ) {
+			shared()[index] = block->next;
+			return block;
+		}
+
+		return ::operator new( ( index + 1 ) * SEQ_POOL_STEP );
+	}
+
+	if( pool->lists[index] == nullptr ) {
+		pool->lists[index] = refill( index, ( index + 1 ) * SEQ_POOL_STEP );
+	}
+
+	block = pool->lists[index];
+	pool->lists[index] = block->next;
+	pool->allocations ++;
+
+	return block;
+
+}
+
+void seq::Pool::release( void* ptr, size_t size ) noexcept {
+
+	const size_t index = ( size - 1 ) / SEQ_POOL_STEP;
+
+	if( ptr == nullptr ) {
+		return;
+	}
+
+	if( size == 0 || index >= SEQ_POOL_CLASSES ) {
+		::operator delete( ptr );
+		return;
+	}
+
+	Block* block = (Block*) ptr;
+	Pool* pool = local();
+
+	if( pool == nullptr ) {
+		std::lock_guard<std::mutex> guard( lock() );
+		block->next = shared()[index];
+		shared()[index] = block;
+		return;
+	}
+
+	block->next = pool->lists[index];
+	pool->lists[index] = block;
+	pool->releases ++;
+
+}
+
+unsigned long seq::Pool::getAllocations() noexcept {
+	Pool* pool = local();
+	return pool ? pool->allocations : 0;
+}
+
+unsigned long seq::Pool::getReleases() noexcept {
+	Pool* pool = local();
+	return pool ? pool->releases : 0;
+}
+
+unsigned long seq::Pool::getChunks() noexcept {
+	Pool* pool = local();
+	return pool ? pool->chunks : 0;
+}
+
+seq::FunctionBody::FunctionBody( seq::Stream& _commands ): commands( &_commands ) {
+
+	// commands other than streams are kept in all groups, and rejected by executeCommand
+	for( byte tags = 0; tags < 8; tags ++ ) {
+		this->offsets[tags] = this->streams.size();
+
+		for( unsigned int i = 0; i < _commands.size(); i ++ ) {
+			seq::Generic& command = _commands[i];
+
+			if( command.getDataType() != seq::DataType::Stream || command.Stream().matchesTags( tags ) ) {
+				this->streams.push_back( i );
+			}
+		}
+	}
+
+	this->offsets[8] = this->streams.size();
+
+}
+
+seq::CallSite::CallSite(): generation( 0 ), native( nullptr ), level( 0 ), slot( 0 ) {}
+
+seq::FunctionCache::FunctionCache( bool _pure, std::vector<std::string> _names ): pure( _pure ), names( std::move( _names ) ) {}
+
+seq::CommandResult::CommandResult( seq::CommandResult::ResultType _stt ): stt( _stt ) {}
+
+seq::CommandResult::CommandResult( seq::CommandResult::ResultType _stt, seq::Stream&& _acc ): stt( _stt ), acc( std::move( _acc ) ) {}
+
+seq::Executor::Executor( Executor* parent ) {
+	this->stack.push();
+	this->strictMath = false;
+	this->parent = parent;
+	this->depth = 0;
+	this->engine = seq::Engine::Tree;
+	this->jitEnabled = true;
+	this->memoization = true;
+	this->cacheHits = 0;
+	this->cacheMisses = 0;
+	this->invalidate();
+}
+
+seq::Executor::Executor(): Executor( nullptr ) {};
+
+void seq::Executor::inject( std::string name, seq::type::Native native ) {
+	this->natives[ name ] = native;
+	this->invalidate();
+}
+
+void seq::Executor::define( std::string name, seq::Stream stream ) {
+	this->getTopLevel()->setSlot( this->intern( name ), std::move( stream ) );
+	this->invalidate();
+}
+
+seq::StackLevel* seq::Executor::getLevel( int level ) {
+	if( level < 0 || level >= (int) this->stack.size() ) {
+		return nullptr;
+	}
+
+	return &(this->stack[ level ]);
+}
+
+seq::StackLevel* seq::Executor::getTopLevel() {
+	return &(this->stack.back());
+}
+
+void seq::Executor::reset() {
+	this->natives.clear();
+	this->invalidate();
+}
+
+std::string seq::Executor::getResultString() {
+	return seq::util::stringCast( this->getResult() ).String().getString();
+}
+
+seq::Generic seq::Executor::getResult() {
+	if( this->result.size() > 0 ) {
+		return this->result.at(0);
+	}else{
+		return seq::util::newNull();
+	}
+}
+
+seq::Stream& seq::Executor::getResults() {
+	return this->result;
+}
+
+void seq::Executor::setStrictMath( bool flag ) {
+	strictMath = flag;
+}
+
+void seq::Executor::setEngine( seq::Engine engine ) {
+	this->engine = engine;
+}
+
+void seq::Executor::setJit( bool flag ) {
+	jitEnabled = flag;
+}
+
+void seq::Executor::setMemoization( bool flag ) {
+	memoization = flag;
+}
+
+unsigned long seq::Executor::getCacheHits() {
+	return this->cacheHits;
+}
+
+unsigned long seq::Executor::getCacheMisses() {
+	return this->cacheMisses;
+}
+
+void seq::Executor::execute( const seq::ByteBuffer& bb, seq::Stream args, bool stack ) {
+
+	// decoded bodies are keyed by their address in the bytecode,
+	// so they can only be reused for as long as the buffer lives
+	if( this->depth == 0 ) {
+		this->decoded.clear();
+		this->lowered.clear();
+		this->functions.clear();
+		this->closures.clear();
+		this->caches.clear();
+		this->bodies.clear();
+		this->strings.clear();
+		this->trees.clear();
+		this->batches.clear();
+		this->sites.clear();
+		this->names.clear();
+		this->operations.clear();
+#		ifdef SEQ_JIT_NATIVE
+		this->nativeExprs.clear();
+		this->nativeFlowcs.clear();
+		this->jit.clear();
+#		endif
+	}
+
+	// nested programs are forgotten once they finish, as their
+	// buffers can be freed and reused while the outer one runs
+	const byte* first = bb.getReader().bytes();
+	const size_t mark = this->operations.size();
+	this->buffers.emplace_back( first, first + bb.size() );
+	this->depth ++;
+
+	try{
+		// both returned and exited streams become the result
+		this->result = std::move( this->executeFunction( bb.getReader(), std::move( args ), true, stack ).acc );
+	}catch( seq::ExecutorInterrupt& ex ) {
+		// this->result set by the this->exit method
+	}catch( ... ) {
+		this->depth --;
+		this->releaseBuffer( mark );
+		throw;
+	}
+
+	this->depth --;
+	this->releaseBuffer( mark );
+}
+
+std::vector<std::string> seq::Executor::link( const seq::ByteBuffer& bb ) {
+
+	std::vector<std::string> called;
+	std::vector<std::string> unresolved;
+	std::unordered_set<std::string> defined;
+
+	seq::BufferReader br = bb.getReader();
+	this->linkNames( this->decode( br ), called, defined );
+
+	for( std::string& name : called ) {
+
+		// names called by the program are first looked up in the natives
+		if( this->natives.find( name ) != this->natives.end() ) {
+			continue;
+		}
+
+		// natives of the parent executors are bound to this executor
+		seq::type::Native native = this->resolveNative( name );
+
+		if( native != nullptr ) {
+			this->inject( name, native );
+			continue;
+		}
+
+		if( defined.find( name ) == defined.end() && !this->hasName( name ) ) {
+			unresolved.push_back( name );
+		}
+
+	}
+
+	return unresolved;
+
+}
+
+void seq::Executor::exit( seq::Stream& stream, byte code ) {
+	// stop program execution, this is only used by natives,
+	// the executor itself passes the Exit result up the call chain
+	this->result = std::move( stream );
+	throw seq::ExecutorInterrupt( code );
+}
+
+seq::CommandResult seq::Executor::executeFunction( seq::BufferReader fbr, seq::Stream input_stream, bool end, bool stack ) {
+
+	// the register machine executes the whole call tree by itself
+	if( this->engine == seq::Engine::Register ) {
+		return this->executeRegister( this->lowerFunction( fbr ), std::move( input_stream ), end, stack );
+	}
+
+	// push new stack into stack array
+	if( stack ) this->stack.push();
+
+	// accumulator of all returned entities
+	seq::Stream acc;
+
+	// turn end flag into offset
+	int o = (end ? 0 : -1);
+
+	// function body is decoded (and partitioned by tags) only once, on first use
+	seq::FunctionBody* body = &this->getBody( fbr );
+
+	// the input stream (owned by this call) is used as a double-ended work queue, it's stored in
+	// reverse order so that both dropping the consumed arguments and reinserting arguments
+	// with 'again' happen at the back of the vector, in time proportional to their count
+	seq::Stream& queue = input_stream;
+	std::reverse( queue.begin(), queue.end() );
+
+	// execute scope for each queued element
+	for ( long i = 0; i <= (long) queue.size() + o; i ++ ) {
+
+		const long size = queue.size();
+		const byte tags = seq::util::packTags( i, size );
+
+		// set current stack argument, every element is visited only once so it can be moved
+		this->getTopLevel()->setArg( (i == size) ? seq::Generic( seq::type::Null( false ) ) : std::move( queue[size - 1 - i] ) );
+
+		// iterate over function code, streams not matching the tags are skipped
+		for( unsigned int j = body->offsets[tags]; j < body->offsets[tags + 1]; j ++ ) {
+
+			seq::Generic& command = (*body->commands)[ body->streams[j] ];
+
+			// a call in tail position, in the last iteration, can reuse the stack level
+			// as nothing else would be done by this function after the call returns,
+			// the result is constructed in place as this frame is part of every recursion
+			const bool tail = stack && i == size + o && command.getDataType() == seq::DataType::Stream && command.Stream().isTail();
+			seq::Generic callee( nullptr );
+			seq::CommandResult cr = tail ? this->executeTail( command.Stream(), callee ) : this->executeCommand( command, tags );
+
+			if( callee.getRaw() != nullptr && callee.getDataType() == seq::DataType::Func ) {
+				auto& func = callee.Function();
+
+				// replace the current function with the called one, the
+				// accumulator is kept as the function would return to it anyway
+				body = &this->getBody( func.getReader() );
+				o = func.hasEnd() ? 0 : -1;
+				queue = std::move( cr.acc );
+				std::reverse( queue.begin(), queue.end() );
+				this->stack.pop();
+				this->stack.push();
+				i = -1;
+				break;
+			}
+
+			// check state
+			switch( cr.stt ) {
+
+				case seq::CommandResult::ResultType::Return:
+					// insert returned data to function output stream
+					acc.insert( acc.end(), std::make_move_iterator( cr.acc.begin() ), std::make_move_iterator( cr.acc.end() ) );
+					break;
+
+				case seq::CommandResult::ResultType::Break:
+					// exit scope
+					goto exit;
+					break;
+
+				case seq::CommandResult::ResultType::Exit:
+					// stop program execution, pass the result to the caller
+					if( stack ) this->stack.pop();
+					return cr;
 
 				case seq::CommandResult::ResultType::Final:
 					// exit scope and return value
-					acc.insert(acc.end(), cr.acc.begin(), cr.acc.end());
+					acc.insert( acc.end(), std::make_move_iterator( cr.acc.begin() ), std::make_move_iterator( cr.acc.end() ) );
 					goto exit;
 					break;
 
 				case seq::CommandResult::ResultType::Again:
 					// add returned arguments to CURRENT input stream
 					if( i == size ) throw RuntimeError( "Native function 'again' can not be called from 'end' tagged stream!" );
-					input_stream.erase( input_stream.begin(), input_stream.begin() + i + 1 );
-					input_stream.insert( input_stream.begin(), cr.acc.begin(), cr.acc.end() );
+					queue.erase( queue.end() - i - 1, queue.end() );
+					queue.insert( queue.end(), std::make_move_iterator( cr.acc.rbegin() ), std::make_move_iterator( cr.acc.rend() ) );
 					i = -1;
 					break;
 
@@ -2658,25 +4559,64 @@ seq::Stream seq::Executor::executeFunction( seq::BufferReader fbr, seq::Stream&
 	exit:
 
 	// pop scope from stack
-	if( stack ) this->stack.pop_back();
+	if( stack ) this->stack.pop();
 
 	// return all accumulated entities
-	return acc;
+	return CommandResult( seq::CommandResult::ResultType::None, std::move(acc) );
+}
+
+seq::CommandResult seq::Executor::executeTail( seq::type::Stream& stream, seq::Generic& callee ) {
+
+	// tail streams are in the form: (#return|#final) << (#name|#{...}) << ...
+	seq::Stream& gs = this->decode( stream.getReader() );
+
+	// compute the arguments, if there are none the call is skipped
+	seq::CommandResult cr = this->executeStream( gs, 2 );
+	if( cr.stt != seq::CommandResult::ResultType::None || cr.acc.empty() ) {
+		return cr;
+	}
+
+	seq::Generic& entity = gs[1];
+	seq::Generic target = entity;
+
+	// anchored names are only replaced if they hold a single function
+	if( entity.getDataType() == seq::DataType::Name ) {
+		seq::Stream value;
+		if( this->resolveCall( entity.Name(), value ) == nullptr && value.size() == 1 ) target = value[0];
+	}
+
+	// the called function must not use the stack level of the caller, and the caller
+	// can't have any variables, as those would be visible to the called function
+	if( target.getDataType() == seq::DataType::Func && this->getTopLevel()->isEmpty() && this->isClosed( target.Function().getReader() ) ) {
+		callee = target;
+		return cr;
+	}
+
+	// otherwise execute the call like executeStream would
+	seq::CommandResult call = this->executeAnchor( entity, cr.acc );
+	if( call.stt != seq::CommandResult::ResultType::None || call.acc.empty() ) {
+		return call;
+	}
+
+	return CommandResult( (seq::CommandResult::ResultType) (byte) gs[0].VMCall().getCall(), std::move( call.acc ) );
 }
 
-seq::CommandResult seq::Executor::executeCommand( seq::TokenReader* tr, byte tags ) {
+seq::CommandResult seq::Executor::executeCommand( seq::Generic& command, byte tags ) {
 
 	// functions can only contain streams
-	if( tr->getDataType() == seq::DataType::Stream ) {
+	if( command.getDataType() == seq::DataType::Stream ) {
 
 		// execute stream if stream tags match current state
-		auto& stream = tr->getGeneric().Stream();
+		auto& stream = command.Stream();
 
 		if( stream.matchesTags( tags ) ) {
-			seq::Stream s = stream.getReader().readAll();
-			return this->executeStream( s );
+			if( this->engine == seq::Engine::Threaded ) {
+				return this->executeThreaded( this->lower( stream.getReader() ) );
+			}
+
+			return this->executeStream( this->decode( stream.getReader() ) );
 		}else{
-			return CommandResult( seq::CommandResult::ResultType::None, seq::Stream() );
+			return CommandResult( seq::CommandResult::ResultType::None );
 		}
 
 	}
@@ -2684,31 +4624,40 @@ seq::CommandResult seq::Executor::executeCommand( seq::TokenReader* tr, byte tag
 	throw seq::InternalError( "Invalid command in function!" );
 }
 
-seq::CommandResult seq::Executor::executeStream( seq::Stream& gs ) {
+seq::CommandResult seq::Executor::executeStream( seq::Stream& gs, int first ) {
 
+	// the stream is evaluated from right to left, so the accumulator is kept
+	// in reverse order (new entities are appended) and only flipped when it's consumed
 	seq::Stream acc;
 
+	// holds the computed value of unsolid entities,
+	// the given stream can be shared so it must not be modified
+	seq::Generic solid( nullptr );
+
 	// iterate over stream entities
-	for( int i = gs.size() - 1; i >= 0; i -- ) {
+	for( int i = gs.size() - 1; i >= first; i -- ) {
 
-		seq::Generic& g = gs[i];
-		seq::DataType t = g.getDataType();
+		seq::Generic* entity = &gs[i];
+		seq::DataType t = entity->getDataType();
 
 		// if type is unsolid compute real value
 		if( t == seq::DataType::Expr || t == seq::DataType::Arg ) {
-			g = this->executeExpr( g );
-			t = g.getDataType();
+			solid = this->executeExpr( *entity );
+			entity = &solid;
+			t = solid.getDataType();
 		}
 
+		seq::Generic& g = *entity;
+
 		// handle embedded (nested) streams
 		if( t == seq::DataType::Stream ) {
-			Stream ss = g.Stream().getReader().readAll();
-			seq::CommandResult cr = this->executeStream( ss );
+			seq::CommandResult cr = this->executeStream( this->decode( g.Stream().getReader() ) );
 			if( cr.stt != seq::CommandResult::ResultType::None ) {
+				if( cr.stt == seq::CommandResult::ResultType::Exit ) return cr;
 				throw seq::InternalError( "Invalid result of embedded stream!" );
 			}
 
-			acc.insert( acc.begin(), cr.acc.begin(), cr.acc.end() );
+			acc.insert( acc.end(), std::make_move_iterator( cr.acc.rbegin() ), std::make_move_iterator( cr.acc.rend() ) );
 			continue;
 		}
 
@@ -2720,12 +4669,14 @@ seq::CommandResult seq::Executor::executeStream( seq::Stream& gs ) {
 				continue;
 			}
 
+			std::reverse( acc.begin(), acc.end() );
+
 			// if entity is a VM Call
 			if( t == seq::DataType::VMCall ) {
 
 				// get VMCall type and using a hacky way cast it to ResultType, then return
 				auto stt = (seq::CommandResult::ResultType) (byte) g.VMCall().getCall();
-				return CommandResult( stt, acc );
+				return CommandResult( stt, std::move(acc) );
 
 			}else{
 
@@ -2733,6 +4684,7 @@ seq::CommandResult seq::Executor::executeStream( seq::Stream& gs ) {
 				seq::CommandResult cr = this->executeAnchor( g, acc );
 				if( cr.stt == seq::CommandResult::ResultType::None ) {
 					acc = std::move(cr.acc);
+					std::reverse( acc.begin(), acc.end() );
 				}else{
 					return cr;
 				}
@@ -2747,438 +4699,2365 @@ seq::CommandResult seq::Executor::executeStream( seq::Stream& gs ) {
 
 			if( name.getDefine() ) { // define variable (set)
 
-				this->defineName( name.getName(), acc );
+				std::reverse( acc.begin(), acc.end() );
+				this->defineName( name, std::move( acc ) );
 				acc.clear();
 
 			}else{ // read variable from stack
 
-				auto tmp = this->resolveName( name.getName(), name.getAnchor() );
+				auto tmp = this->resolveName( name, name.getAnchor() );
 
-				// append tmp to acc
-				acc.insert( acc.begin(), tmp.begin(), tmp.end() );
+				// prepend tmp to acc
+				acc.insert( acc.end(), std::make_move_iterator( tmp.rbegin() ), std::make_move_iterator( tmp.rend() ) );
 			}
 
 			continue;
 		}
 
 		// if entity is a simple, solid value add it to acc
-		acc.insert( acc.begin(), g );
+		acc.push_back( g );
 	}
 
+	std::reverse( acc.begin(), acc.end() );
 	return CommandResult( seq::CommandResult::ResultType::None, std::move(acc) );
 }
 
-seq::CommandResult seq::Executor::executeAnchor( seq::Generic entity, seq::Stream& input_stream ) {
+seq::Instruction::Op seq::Instruction::classify( seq::Generic& entity ) {
 
-	seq::DataType type = entity.getDataType();
+	const seq::DataType type = entity.getDataType();
 
-	// if given entity is a variable
-	if( type == seq::DataType::Name ) {
+	if( type == seq::DataType::Expr || type == seq::DataType::Arg ) return Op::Eval;
+	if( type == seq::DataType::Stream ) return Op::Stream;
+	if( entity.getAnchor() ) return ( type == seq::DataType::VMCall ) ? Op::Call : Op::Anchor;
+	if( type == seq::DataType::Name ) return entity.Name().getDefine() ? Op::Set : Op::Get;
 
-		seq::type::Name& name = entity.Name();
+	return Op::Push;
+}
 
-		// test if name refers to native function, and if so execute it
-		try{
-			// this will throw std::out_of_range if native is not found
-			seq::Stream* ptr = resolveNative( name.getName() )( &input_stream );
+// use labels-as-values (GCC, Clang) for dispatch if available,
+// otherwise fallback to a regular switch statement
+#if defined( __GNUC__ ) && !defined( SEQ_NO_COMPUTED_GOTO )
+#	define SQOP( name ) op_##name:
+#	define SQNEXT { g = (++ ip)->value; goto *ip->label; }
+#	define SQDISPATCH( code ) { goto *labels[ (byte) (code) ]; }
+#	define SQGOTO
+#else
+#	define SQOP( name ) case seq::Instruction::Op::name:
+#	define SQNEXT { g = (++ ip)->value; op = ip->op; continue; }
+#	define SQDISPATCH( code ) { op = (code); continue; }
+#endif
 
-			// If null pointer is returned the input_stream is to be treated as output
-			if( ptr != nullptr ) {
-				input_stream = std::move( *ptr );
-				delete ptr;
-			}
+seq::CommandResult seq::Executor::executeThreaded( seq::Instruction* entry ) {
 
-			return CommandResult( seq::CommandResult::ResultType::None, input_stream );
-		} catch (std::out_of_range &ignore) {
+	// same as in executeStream, the accumulator is kept in reverse order
+	seq::Stream acc;
 
-			// if it isn't native, try finding it on the stack
-			seq::Stream s = this->resolveName( name.getName(), true );
-			s.insert( s.end(), input_stream.begin(), input_stream.end() );
-			return this->executeStream( s );
+	// holds the computed value of unsolid entities
+	seq::Generic solid( nullptr );
 
-		}
+	seq::Instruction* ip = entry;
+	seq::Generic* g = ip->value;
 
-	}
+#	ifdef SQGOTO
+	static const void* const labels[] = {
+		&&op_Push, &&op_Eval, &&op_Stream, &&op_Call, &&op_Anchor, &&op_Set, &&op_Get, &&op_End
+	};
 
-	// execute anchored function
-	if( type == seq::DataType::Func ) {
-		auto& func = entity.Function();
-		return CommandResult( seq::CommandResult::ResultType::None, this->executeFunction( func.getReader(), input_stream, func.hasEnd() ) );
+	// instructions are linked to their handlers on first execution
+	if( ip->label == nullptr ) {
+		for( seq::Instruction* it = ip; ; it ++ ) {
+			it->label = labels[ (byte) it->op ];
+			if( it->op == seq::Instruction::Op::End ) break;
+		}
+	}
+
+	goto *ip->label;
+#	else
+	seq::Instruction::Op op = ip->op;
+
+	for( ;; ) switch( op ) {
+#	endif
+
+	SQOP( Push ) {
+		acc.push_back( *g );
+		SQNEXT;
+	}
+
+	SQOP( Eval ) {
+		solid = this->executeExpr( *g );
+		g = &solid;
+
+		// computed values are never unsolid
+		const seq::Instruction::Op code = seq::Instruction::classify( solid );
+		SQDISPATCH( code == seq::Instruction::Op::Eval ? seq::Instruction::Op::Push : code );
+	}
+
+	// computed gotos don't call destructors, so locals
+	// of the handlers below are scoped before dispatching
+	SQOP( Stream ) {
+		{
+			seq::CommandResult cr = this->executeThreaded( this->lower( g->Stream().getReader() ) );
+			if( cr.stt != seq::CommandResult::ResultType::None ) {
+				if( cr.stt == seq::CommandResult::ResultType::Exit ) return cr;
+				throw seq::InternalError( "Invalid result of embedded stream!" );
+			}
+
+			acc.insert( acc.end(), std::make_move_iterator( cr.acc.rbegin() ), std::make_move_iterator( cr.acc.rend() ) );
+		}
+		SQNEXT;
+	}
+
+	SQOP( Call ) {
+		if( acc.size() == 0 ) SQNEXT;
+
+		std::reverse( acc.begin(), acc.end() );
+		return CommandResult( (seq::CommandResult::ResultType) (byte) g->VMCall().getCall(), std::move(acc) );
+	}
+
+	SQOP( Anchor ) {
+		if( acc.size() == 0 ) SQNEXT;
+
+		std::reverse( acc.begin(), acc.end() );
+		{
+			seq::CommandResult cr = this->executeAnchor( *g, acc );
+			if( cr.stt != seq::CommandResult::ResultType::None ) {
+				return cr;
+			}
+
+			acc = std::move(cr.acc);
+		}
+		std::reverse( acc.begin(), acc.end() );
+		SQNEXT;
+	}
+
+	SQOP( Set ) {
+		std::reverse( acc.begin(), acc.end() );
+		this->defineName( g->Name(), std::move( acc ) );
+		acc.clear();
+		SQNEXT;
+	}
+
+	SQOP( Get ) {
+		{
+			auto& name = g->Name();
+			auto tmp = this->resolveName( name, name.getAnchor() );
+
+			acc.insert( acc.end(), std::make_move_iterator( tmp.rbegin() ), std::make_move_iterator( tmp.rend() ) );
+		}
+		SQNEXT;
+	}
+
+	SQOP( End ) {
+		std::reverse( acc.begin(), acc.end() );
+		return CommandResult( seq::CommandResult::ResultType::None, std::move(acc) );
+	}
+
+#	ifndef SQGOTO
+	}
+#	endif
+
+}
+
+#undef SQOP
+#undef SQNEXT
+#undef SQDISPATCH
+#undef SQGOTO
+
+seq::Operation::Code seq::Operation::classify( seq::Generic& entity ) {
+
+	const seq::DataType type = entity.getDataType();
+
+	if( type == seq::DataType::Expr || type == seq::DataType::Arg ) return Code::Eval;
+	if( type == seq::DataType::Stream ) return Code::Open;
+	if( entity.getAnchor() ) return ( type == seq::DataType::VMCall ) ? Code::Call : Code::Anchor;
+	if( type == seq::DataType::Name ) return entity.Name().getDefine() ? Code::Set : Code::Get;
+
+	return Code::Push;
+}
+
+seq::RegisterFrame::RegisterFrame(): regs( 1 ), index( -1 ), size( 0 ), pc( 0 ), stop( 0 ), reg( 0 ), tags( 0 ), end( false ), stack( false ), dynamic( false ) {}
+
+void seq::RegisterFrame::open( unsigned int _entry, seq::Stream&& _input, bool _end, bool _stack, unsigned int _reg ) {
+	this->queue = std::move( _input );
+	this->index = -1;
+	this->size = 0;
+	this->pc = _entry;
+	this->stop = _entry;
+	this->reg = _reg;
+	this->tags = 0;
+	this->end = _end;
+	this->stack = _stack;
+	this->dynamic = false;
+
+	// arguments are consumed from the back, same as in executeFunction
+	std::reverse( this->queue.begin(), this->queue.end() );
+}
+
+void seq::RegisterFrame::open( seq::Stream&& _stream, unsigned int _reg ) {
+	this->queue = std::move( _stream );
+	this->index = (long) this->queue.size() - 1;
+	this->size = this->queue.size();
+	this->pc = 0;
+	this->stop = 0;
+	this->reg = _reg;
+	this->tags = 0;
+	this->end = false;
+	this->stack = false;
+	this->dynamic = true;
+}
+
+void seq::RegisterFrame::clear() {
+	// registers are always cleared before use, so only the values are released
+	this->queue.clear();
+	this->out.clear();
+	for( seq::Stream& reg : this->regs ) reg.clear();
+}
+
+#ifdef SEQ_JIT_NATIVE
+
+seq::JitCompiler::Entry::Entry(): code( nullptr ), hits( 0 ), boolean( false ) {}
+
+seq::JitCompiler::JitCompiler(): compiled( 0 ) {}
+
+seq::JitCompiler::~JitCompiler() {
+	this->clear();
+}
+
+bool seq::JitCompiler::compileExpression( seq::type::Expression& expr, seq::JitCompiler::Entry& entry ) {
+
+	std::vector<byte> code;
+	std::vector<byte> levels;
+	double bounds[3];
+
+	// both operands are computed into xmm0 and xmm1
+	if( !this->emitOperands( expr, 0, code, levels, bounds ) ) {
+		return false;
+	}
+
+	const seq::ExprOperator op = expr.getOperator();
+	const byte opcode = arithmetic( op );
+
+	if( opcode != 0 ) {
+
+		// op xmm0, xmm1
+		code.insert( code.end(), { 0xF2, 0x0F, opcode, 0xC1 } );
+
+	}else{
+
+		// comparisons are only supported at the top of the expression, the mask
+		// produced by cmpsd is converted to 0.0 or 1.0, the NaN semantics match C++
+		switch( op ) {
+			case seq::ExprOperator::Less: code.insert( code.end(), { 0xF2, 0x0F, 0xC2, 0xC1, 0x01 } ); break;
+			case seq::ExprOperator::NotGreater: code.insert( code.end(), { 0xF2, 0x0F, 0xC2, 0xC1, 0x02 } ); break;
+			case seq::ExprOperator::Equal: code.insert( code.end(), { 0xF2, 0x0F, 0xC2, 0xC1, 0x00 } ); break;
+			case seq::ExprOperator::NotEqual: code.insert( code.end(), { 0xF2, 0x0F, 0xC2, 0xC1, 0x04 } ); break;
+
+			// swap the operands and move the result back to xmm0
+			case seq::ExprOperator::Greater: code.insert( code.end(), { 0xF2, 0x0F, 0xC2, 0xC8, 0x01, 0xF2, 0x0F, 0x10, 0xC1 } ); break;
+			case seq::ExprOperator::NotLess: code.insert( code.end(), { 0xF2, 0x0F, 0xC2, 0xC8, 0x02, 0xF2, 0x0F, 0x10, 0xC1 } ); break;
+
+			default: return false;
+		}
+
+		// movq rax, xmm0; and eax, 1; cvtsi2sd xmm0, eax
+		code.insert( code.end(), { 0x66, 0x48, 0x0F, 0x7E, 0xC0, 0x83, 0xE0, 0x01, 0xF2, 0x0F, 0x2A, 0xC0 } );
+
+	}
+
+	// ret
+	code.push_back( 0xC3 );
+
+	const void* fn = this->commit( code );
+	if( fn == nullptr ) {
+		return false;
+	}
+
+	entry.code = fn;
+	entry.levels = std::move( levels );
+	entry.boolean = ( opcode == 0 );
+	return true;
+}
+
+bool seq::JitCompiler::compileFlowc( const std::vector<seq::FlowCondition*>& fcs, seq::JitCompiler::Entry& entry ) {
+
+	std::vector<byte> code;
+
+	// the argument is passed in xmm0, matches are accumulated in xmm4
+	// xorpd xmm4, xmm4
+	code.insert( code.end(), { 0x66, 0x0F, 0x57, 0xE4 } );
+
+	for( seq::FlowCondition* fc : fcs ) {
+
+		emitConstant( fc->a.Number().getDouble(), 1, code );
+
+		if( fc->type == seq::FlowCondition::Type::Value ) {
+
+			// cmpeqsd xmm1, xmm0
+			code.insert( code.end(), { 0xF2, 0x0F, 0xC2, 0xC8, 0x00 } );
+
+		}else{
+
+			emitConstant( fc->b.Number().getDouble(), 2, code );
+
+			// cmpltsd xmm1, xmm0; movsd xmm3, xmm0; cmpltsd xmm3, xmm2; andpd xmm1, xmm3
+			code.insert( code.end(), { 0xF2, 0x0F, 0xC2, 0xC8, 0x01, 0xF2, 0x0F, 0x10, 0xD8, 0xF2, 0x0F, 0xC2, 0xDA, 0x01, 0x66, 0x0F, 0x54, 0xCB } );
+
+		}
+
+		// orpd xmm4, xmm1
+		code.insert( code.end(), { 0x66, 0x0F, 0x56, 0xE1 } );
+	}
+
+	// movq rax, xmm4; and eax, 1; ret
+	code.insert( code.end(), { 0x66, 0x48, 0x0F, 0x7E, 0xE0, 0x83, 0xE0, 0x01, 0xC3 } );
+
+	entry.code = this->commit( code );
+	return entry.code != nullptr;
+}
+
+size_t seq::JitCompiler::getCompiled() {
+	return this->compiled;
+}
+
+void seq::JitCompiler::clear() {
+	for( auto& page : this->pages ) {
+		munmap( page.first, page.second );
+	}
+
+	this->pages.clear();
+	this->compiled = 0;
+}
+
+bool seq::JitCompiler::emitNumeric( seq::Generic& entity, byte reg, std::vector<byte>& code, std::vector<byte>& levels, double& bound ) {
+
+	// only xmm0-xmm7 are used, so that no REX prefixes are needed
+	if( reg > 7 ) {
+		return false;
+	}
+
+	switch( entity.getDataType() ) {
+
+		case seq::DataType::Number:
+			bound = std::abs( entity.Number().getDouble() );
+			emitConstant( entity.Number().getDouble(), reg, code );
+			return bound < SEQ_JIT_LIMIT;
+
+		case seq::DataType::Arg: {
+				const byte level = entity.Arg().getLevel();
+				auto it = std::find( levels.begin(), levels.end(), level );
+
+				if( it == levels.end() ) {
+					if( levels.size() == 8 ) return false;
+					it = levels.insert( levels.end(), level );
+				}
+
+				// movsd xmmN, [rdi + slot * 8]
+				const byte slot = (byte) ( it - levels.begin() );
+				code.insert( code.end(), { 0xF2, 0x0F, 0x10, (byte) ( 0x47 | ( reg << 3 ) ), (byte) ( slot * 8 ) } );
+				bound = SEQ_JIT_LIMIT;
+			}
+			return true;
+
+		case seq::DataType::Expr: {
+				auto& expr = entity.Expression();
+				const byte opcode = arithmetic( expr.getOperator() );
+				double bounds[3];
+
+				if( opcode == 0 || !this->emitOperands( expr, reg, code, levels, bounds ) ) {
+					return false;
+				}
+
+				// natural numbers are computed exactly by the interpreter, so all values
+				// must stay in the range in which doubles can represent every integer
+				switch( expr.getOperator() ) {
+					case seq::ExprOperator::Multiplication: bound = bounds[0] * bounds[1]; break;
+					case seq::ExprOperator::Division: bound = ( bounds[2] >= 1 ) ? bounds[0] : INFINITY; break;
+					default: bound = bounds[0] + bounds[1]; break;
+				}
+
+				if( !( bound < 9007199254740992.0 ) ) {
+					return false;
+				}
+
+				// op xmmN, xmmN+1
+				code.insert( code.end(), { 0xF2, 0x0F, opcode, (byte) ( 0xC0 | ( reg << 3 ) | ( reg + 1 ) ) } );
+			}
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+bool seq::JitCompiler::emitOperands( seq::type::Expression& expr, byte reg, std::vector<byte>& code, std::vector<byte>& levels, double* bounds ) {
+
+	// copy readers, the expression itself can be shared
+	seq::BufferReader lbr = expr.getLeftReader();
+	seq::BufferReader rbr = expr.getRightReader();
+
+	seq::Generic left = lbr.next().getGeneric();
+	seq::Generic right = rbr.next().getGeneric();
+
+	// the smallest possible magnitude of the right operand is only known for constants
+	bounds[2] = ( right.getDataType() == seq::DataType::Number ) ? std::abs( right.Number().getDouble() ) : 0;
+
+	return this->emitNumeric( left, reg, code, levels, bounds[0] ) && this->emitNumeric( right, reg + 1, code, levels, bounds[1] );
+}
+
+byte seq::JitCompiler::arithmetic( seq::ExprOperator op ) {
+	switch( op ) {
+		case seq::ExprOperator::Addition: return 0x58;
+		case seq::ExprOperator::Multiplication: return 0x59;
+		case seq::ExprOperator::Subtraction: return 0x5C;
+		case seq::ExprOperator::Division: return 0x5E;
+		default: return 0;
+	}
+}
+
+void seq::JitCompiler::emitConstant( double value, byte reg, std::vector<byte>& code ) {
+	byte raw[8];
+	memcpy( raw, &value, 8 );
+
+	// mov rax, imm64; movq xmmN, rax
+	code.insert( code.end(), { 0x48, 0xB8 } );
+	code.insert( code.end(), raw, raw + 8 );
+	code.insert( code.end(), { 0x66, 0x48, 0x0F, 0x6E, (byte) ( 0xC0 | ( reg << 3 ) ) } );
+}
+
+const void* seq::JitCompiler::commit( std::vector<byte>& code ) {
+
+	// pages are never writable and executable at the same time, and pages holding
+	// compiled functions are never made writable again, so each function gets its own
+	const size_t size = ( code.size() + SEQ_JIT_PAGE - 1 ) & ~(size_t) ( SEQ_JIT_PAGE - 1 );
+	void* page = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+
+	if( page == MAP_FAILED ) {
+		return nullptr;
+	}
+
+	byte* fn = (byte*) page;
+	memcpy( fn, code.data(), code.size() );
+
+	if( mprotect( page, size, PROT_READ | PROT_EXEC ) != 0 ) {
+		munmap( page, size );
+		return nullptr;
+	}
+
+	this->pages.emplace_back( fn, size );
+	this->compiled ++;
+	return fn;
+}
+
+#endif
+
+seq::CommandResult seq::Executor::executeRegister( unsigned int entry, seq::Stream input_stream, bool end, bool stack ) {
+
+	// Sequensa calls push frames instead of recursing, the frames are kept in the executor
+	// and reused, frames below the base belong to the calls (of natives) this one is nested in
+	auto& frames = this->frames;
+	const size_t base = frames.size();
+	frames.push().open( entry, std::move( input_stream ), end, stack, 0 );
+	if( stack ) this->stack.push();
+
+	// holds the computed value of unsolid entities
+	seq::Generic solid( nullptr );
+
+	// result passed to the current frame, and the register it's passed to
+	seq::CommandResult cr( seq::CommandResult::ResultType::None );
+	unsigned int reg = 0;
+	bool pending = false;
+
+	try{
+
+		while( true ) {
+
+			if( pending ) {
+				pending = false;
+
+				if( cr.stt == seq::CommandResult::ResultType::Exit ) {
+
+					// stop program execution, pop all remaining stack levels
+					while( frames.size() > base ) {
+						if( frames.back().stack ) this->stack.pop();
+						frames.pop();
+					}
+
+					return cr;
+				}
+
+				// the first frame returned
+				if( frames.size() == base ) {
+					return cr;
+				}
+
+				seq::RegisterFrame& f = frames.back();
+
+				// result of an anchor replaces the register
+				if( cr.stt == seq::CommandResult::ResultType::None ) {
+					f.regs[reg].assign( std::make_move_iterator( cr.acc.rbegin() ), std::make_move_iterator( cr.acc.rend() ) );
+					continue;
+				}
+
+				// anchored names pass the result to their caller, like in executeStream
+				if( f.dynamic ) {
+					reg = f.reg;
+					frames.pop();
+					pending = true;
+					continue;
+				}
+
+				if( reg != 0 ) {
+					throw seq::InternalError( "Invalid result of embedded stream!" );
+				}
+
+				switch( cr.stt ) {
+
+					case seq::CommandResult::ResultType::Return:
+						// insert returned data to function output stream
+						f.out.insert( f.out.end(), std::make_move_iterator( cr.acc.begin() ), std::make_move_iterator( cr.acc.end() ) );
+						f.pc = f.stop;
+						break;
+
+					case seq::CommandResult::ResultType::Again:
+						// add returned arguments to the front of the argument queue
+						if( f.index == f.size ) throw RuntimeError( "Native function 'again' can not be called from 'end' tagged stream!" );
+						f.queue.erase( f.queue.end() - f.index - 1, f.queue.end() );
+						f.queue.insert( f.queue.end(), std::make_move_iterator( cr.acc.rbegin() ), std::make_move_iterator( cr.acc.rend() ) );
+						f.index = -1;
+						f.pc = f.stop;
+						break;
+
+					case seq::CommandResult::ResultType::Final:
+					case seq::CommandResult::ResultType::Break:
+						// exit function, Final also returns the value
+						if( cr.stt == seq::CommandResult::ResultType::Final ) {
+							f.out.insert( f.out.end(), std::make_move_iterator( cr.acc.begin() ), std::make_move_iterator( cr.acc.end() ) );
+						}
+
+						if( f.stack ) this->stack.pop();
+						cr = CommandResult( seq::CommandResult::ResultType::None, std::move( f.out ) );
+						reg = f.reg;
+						frames.pop();
+						pending = true;
+						break;
+
+					default:
+						break;
+
+				}
+
+				continue;
+			}
+
+			seq::RegisterFrame& f = frames.back();
+			seq::Operation op;
+
+			if( f.dynamic ) {
+
+				// streams of anchored names are only known at runtime, so they are classified here
+				if( f.index < 0 ) {
+					cr = CommandResult( seq::CommandResult::ResultType::None );
+					cr.acc.assign( std::make_move_iterator( f.regs[0].rbegin() ), std::make_move_iterator( f.regs[0].rend() ) );
+					reg = f.reg;
+					frames.pop();
+					pending = true;
+					continue;
+				}
+
+				op.value = &f.queue[ f.index -- ];
+				op.target = SEQ_NO_ENTRY;
+				op.reg = 0;
+				op.code = seq::Operation::classify( *op.value );
+
+				// variables never hold embedded streams, but if they did, those are executed by executeStream
+				if( op.code == seq::Operation::Code::Open ) {
+					cr = this->executeStream( this->decode( op.value->Stream().getReader() ) );
+
+					if( cr.stt == seq::CommandResult::ResultType::None ) {
+						f.regs[0].insert( f.regs[0].end(), std::make_move_iterator( cr.acc.rbegin() ), std::make_move_iterator( cr.acc.rend() ) );
+						continue;
+					}
+
+					if( cr.stt != seq::CommandResult::ResultType::Exit ) {
+						throw seq::InternalError( "Invalid result of embedded stream!" );
+					}
+
+					pending = true;
+					continue;
+				}
+
+			}else{
+				op = this->operations[ f.pc ++ ];
+			}
+
+			// computed values are never unsolid
+			if( op.code == seq::Operation::Code::Eval ) {
+				solid = this->executeExpr( *op.value );
+				op.value = &solid;
+				op.code = seq::Operation::classify( solid );
+
+				if( op.code == seq::Operation::Code::Eval || op.code == seq::Operation::Code::Open ) {
+					op.code = seq::Operation::Code::Push;
+				}
+			}
+
+			switch( op.code ) {
+
+				case seq::Operation::Code::Push:
+					f.regs[op.reg].push_back( *op.value );
+					break;
+
+				case seq::Operation::Code::Call: {
+					seq::Stream& acc = f.regs[op.reg];
+					if( acc.empty() ) break;
+
+					std::reverse( acc.begin(), acc.end() );
+					cr = CommandResult( (seq::CommandResult::ResultType) (byte) op.value->VMCall().getCall(), std::move( acc ) );
+					acc.clear();
+					reg = op.reg;
+					pending = true;
+					break;
+				}
+
+				case seq::Operation::Code::Anchor: {
+					seq::Stream& acc = f.regs[op.reg];
+					if( acc.empty() ) break;
+
+					std::reverse( acc.begin(), acc.end() );
+					seq::Generic& entity = *op.value;
+					const seq::DataType type = entity.getDataType();
+
+					// call function
+					if( type == seq::DataType::Func ) {
+						auto& func = entity.Function();
+						const unsigned int target = ( op.target != SEQ_NO_ENTRY ) ? op.target : this->lowerFunction( func.getReader() );
+
+						frames.push().open( target, std::move( acc ), func.hasEnd(), true, op.reg );
+						acc.clear();
+						this->stack.push();
+						break;
+					}
+
+					if( type == seq::DataType::Name ) {
+						seq::Stream stream;
+						seq::type::Native native = this->resolveCall( entity.Name(), stream );
+
+						// call variable
+						if( native == nullptr ) {
+							stream.insert( stream.end(), std::make_move_iterator( acc.begin() ), std::make_move_iterator( acc.end() ) );
+							acc.clear();
+
+							frames.push().open( std::move( stream ), op.reg );
+							break;
+						}
+
+						seq::Stream* ptr = native( &acc );
+
+						// If null pointer is returned the acc is to be treated as output
+						if( ptr != nullptr ) {
+							acc = std::move( *ptr );
+							delete ptr;
+						}
+
+						std::reverse( acc.begin(), acc.end() );
+						break;
+					}
+
+					// flowc and casts are executed in place
+					seq::CommandResult ar = this->executeAnchor( entity, acc );
+					acc.assign( std::make_move_iterator( ar.acc.rbegin() ), std::make_move_iterator( ar.acc.rend() ) );
+					break;
+				}
+
+				case seq::Operation::Code::Set: {
+					seq::Stream& acc = f.regs[op.reg];
+					std::reverse( acc.begin(), acc.end() );
+					this->defineName( op.value->Name(), std::move( acc ) );
+					acc.clear();
+					break;
+				}
+
+				case seq::Operation::Code::Get: {
+					auto& name = op.value->Name();
+					auto tmp = this->resolveName( name, name.getAnchor() );
+
+					seq::Stream& acc = f.regs[op.reg];
+					acc.insert( acc.end(), std::make_move_iterator( tmp.rbegin() ), std::make_move_iterator( tmp.rend() ) );
+					break;
+				}
+
+				case seq::Operation::Code::Open:
+					if( f.regs.size() <= op.reg ) {
+						f.regs.resize( op.reg + 1 );
+					}else{
+						f.regs[op.reg].clear();
+					}
+					break;
+
+				case seq::Operation::Code::Merge: {
+					seq::Stream& acc = f.regs[op.reg];
+					f.regs[op.reg - 1].insert( f.regs[op.reg - 1].end(), std::make_move_iterator( acc.begin() ), std::make_move_iterator( acc.end() ) );
+					acc.clear();
+					break;
+				}
+
+				case seq::Operation::Code::Match:
+					// skip stream if tags don't match, else remember where it ends
+					if( op.value->Stream().matchesTags( f.tags ) ) {
+						f.stop = op.target;
+						f.regs[0].clear();
+					}else{
+						f.pc = op.target;
+					}
+					break;
+
+				case seq::Operation::Code::Done:
+					f.regs[0].clear();
+					break;
+
+				case seq::Operation::Code::Next: {
+					const long size = f.queue.size();
+					f.index ++;
+
+					if( f.index <= size + ( f.end ? 0 : -1 ) ) {
+						f.size = size;
+						f.tags = seq::util::packTags( f.index, size );
+						f.pc = op.target;
+
+						// set current stack argument, every element is visited only once so it can be moved
+						this->getTopLevel()->setArg( (f.index == size) ? seq::Generic( seq::type::Null( false ) ) : std::move( f.queue[size - 1 - f.index] ) );
+					}else{
+						if( f.stack ) this->stack.pop();
+						cr = CommandResult( seq::CommandResult::ResultType::None, std::move( f.out ) );
+						reg = f.reg;
+						frames.pop();
+						pending = true;
+					}
+					break;
+				}
+
+				default:
+					throw seq::InternalError( "Invalid operation!" );
+
+			}
+		}
+
+	}catch( ... ) {
+		// the frames are released, the stack levels are left to the caller like in executeFunction
+		while( frames.size() > base ) frames.pop();
+		throw;
+	}
+
+}
+
+seq::CommandResult seq::Executor::executeAnchor( seq::Generic& entity, seq::Stream& input_stream ) {
+
+	seq::DataType type = entity.getDataType();
+	seq::Generic* target = &entity;
+	seq::Stream s;
+
+	// if given entity is a variable
+	if( type == seq::DataType::Name ) {
+
+		seq::type::Name& name = entity.Name();
+
+		// test if name refers to native function, and if so execute it
+		seq::type::Native native = this->resolveCall( name, s );
+
+		if( native != nullptr ) {
+			seq::Stream* ptr = native( &input_stream );
+
+			// If null pointer is returned the input_stream is to be treated as output
+			if( ptr != nullptr ) {
+				input_stream = std::move( *ptr );
+				delete ptr;
+			}
+
+			return CommandResult( seq::CommandResult::ResultType::None, std::move( input_stream ) );
+		}
+
+		// if it isn't native, it was found on the stack, a single function is called directly
+		// as executeStream would do the same if all arguments are plain values, this keeps
+		// recursive calls of named functions from using two more frames of the C++ stack
+		const auto plain = [] ( seq::Generic& arg ) { return seq::Instruction::classify( arg ) == seq::Instruction::Op::Push; };
+
+		if( s.size() == 1 && s[0].getDataType() == seq::DataType::Func && s[0].getAnchor() && !input_stream.empty() && std::all_of( input_stream.begin(), input_stream.end(), plain ) ) {
+			target = &s[0];
+			type = seq::DataType::Func;
+		}else{
+			s.insert( s.end(), std::make_move_iterator( input_stream.begin() ), std::make_move_iterator( input_stream.end() ) );
+			return this->executeStream( s );
+		}
+
+	}
+
+	// execute anchored function
+	if( type == seq::DataType::Func ) {
+		auto& func = target->Function();
+
+		// only calls with a single argument are memoized
+		if( this->memoization && input_stream.size() == 1 ) {
+			return this->executeMemoized( func, input_stream );
+		}
+
+		// simple functions of numbers are computed for the whole stream at once
+		if( input_stream.size() >= SEQ_BATCH_MIN && !func.hasEnd() ) {
+			seq::Stream output;
+
+			if( this->executeBatch( func, input_stream, output ) ) {
+				return CommandResult( seq::CommandResult::ResultType::None, std::move( output ) );
+			}
+		}
+
+		return this->executeFunction( func.getReader(), std::move( input_stream ), func.hasEnd() );
 	}
 
 	// execute anchored flowc
 	if( type == seq::DataType::Flowc ) {
-		return CommandResult( seq::CommandResult::ResultType::None, this->executeFlowc( entity.Flowc().getConditions(), input_stream ) );
+		return CommandResult( seq::CommandResult::ResultType::None, this->executeFlowc( entity.Flowc(), input_stream ) );
+	}
+
+	if( type == seq::DataType::Blob ) {
+		throw seq::RuntimeError( "Invalid '" + entity.Blob().toString() + "' call!" );
+	}
+
+	// if not any of the above, simply cast args to anchor
+	seq::Stream output_stream;
+	for( auto& g : input_stream ) {
+		output_stream.push_back( this->executeCast( entity, g ) );
+	}
+	return CommandResult( seq::CommandResult::ResultType::None, std::move(output_stream) );
+
+}
+
+seq::CommandResult seq::Executor::executeMemoized( seq::type::Function& func, seq::Stream& input_stream ) {
+
+	// this frame is part of every recursive call, so everything that isn't needed
+	// after the call (making the key, checking the bindings) is done by getMemo
+	std::string key;
+	seq::FunctionCache* cache = this->getMemo( func, input_stream[0], key );
+
+	if( cache != nullptr ) {
+		auto it = cache->index.find( key );
+		if( it != cache->index.end() ) {
+			this->cacheHits ++;
+
+			// move entry to the front of the list
+			cache->entries.splice( cache->entries.begin(), cache->entries, it->second );
+			return CommandResult( seq::CommandResult::ResultType::None, seq::Stream( it->second->second ) );
+		}
+
+		this->cacheMisses ++;
+	}
+
+	seq::CommandResult cr = this->executeFunction( func.getReader(), std::move( input_stream ), func.hasEnd() );
+
+	// the cache could have been cleared by a nested call, so the key is checked again
+	if( cache != nullptr && cr.stt == seq::CommandResult::ResultType::None && cache->index.count( key ) == 0 ) {
+		cache->entries.emplace_front( key, cr.acc );
+		cache->index[ key ] = cache->entries.begin();
+
+		// evict least recently used result
+		if( cache->entries.size() > SEQ_MEMO_SIZE ) {
+			cache->index.erase( cache->entries.back().first );
+			cache->entries.pop_back();
+		}
+	}
+
+	return cr;
+}
+
+seq::FunctionCache* seq::Executor::getMemo( seq::type::Function& func, seq::Generic& arg, std::string& key ) {
+
+	seq::FunctionCache& cache = this->getCache( func.getReader() );
+	if( !cache.pure ) {
+		return nullptr;
+	}
+
+	const seq::DataType type = arg.getDataType();
+
+	// make the cache key, only simple values are supported
+	key.assign( 1, (char) ( (byte) type | ( arg.getAnchor() ? 0x80 : 0 ) ) );
+
+	switch( type ) {
+		case seq::DataType::Number: {
+				auto& number = arg.Number();
+
+				// naturals are keyed by their exact value, large ones can share a double
+				if( number.isNatural() ) {
+					const int64_t value = number.getLong();
+					key.push_back( 'n' );
+					key.append( (const char*) &value, sizeof( value ) );
+				}else{
+					const double value = number.getDouble();
+					key.push_back( 'd' );
+					key.append( (const char*) &value, sizeof( value ) );
+				}
+			}
+			break;
+
+		case seq::DataType::Bool:
+			key.push_back( arg.Bool().getBool() );
+			break;
+
+		case seq::DataType::String:
+			key.append( arg.String().getString() );
+			break;
+
+		case seq::DataType::Null:
+			break;
+
+		default:
+			return nullptr;
+	}
+
+	std::vector<const byte*> bindings;
+
+	if( !this->resolveBindings( cache, bindings ) ) {
+		return nullptr;
+	}
+
+	// the results are only valid as long as the called names refer to the same functions
+	if( bindings != cache.bindings ) {
+		cache.bindings = std::move( bindings );
+		cache.entries.clear();
+		cache.index.clear();
+	}
+
+	return &cache;
+}
+
+seq::Generic seq::Executor::executeExprPair( seq::Generic left, seq::Generic right, seq::ExprOperator op, bool anchor ) {
+
+	{
+		const seq::DataType ltype = left.getDataType();
+		const seq::DataType rtype = right.getDataType();
+
+		// if left or right side is and expr or arg pass it through executeExpr
+		if( ltype == seq::DataType::Expr || ltype == seq::DataType::Arg ) left = this->executeExpr(left);
+		if( rtype == seq::DataType::Expr || rtype == seq::DataType::Arg ) right = this->executeExpr(right);
+	}
+
+	const seq::DataType ltype = left.getDataType();
+	const seq::DataType rtype = right.getDataType();
+
+	// handle accessor operator
+	if( op == seq::ExprOperator::Accessor ) {
+
+		if( ltype != seq::DataType::Name || rtype != seq::DataType::Number ) {
+			throw seq::RuntimeError( "Invalid accessor operands, stream and number expected!" );
+		}
+
+		// try returning element from stream (left) at index (right)
+		const Stream stream = this->resolveName( left.Name(), anchor );
+		const long index = right.Number().getLong();
+
+		if( index < 0 || index >= (long) stream.size() ) {
+			return seq::util::newNull(anchor);
+		}
+
+		return stream[index];
+
+	}
+
+	// return null if data types don't match (with exception of Not and BinaryNot)
+	if( rtype != ltype ) {
+		if( op != seq::ExprOperator::Not && op != seq::ExprOperator::BinaryNot ) {
+
+			if( this->strictMath ) {
+				throw seq::RuntimeError( "Expression operators don't match!" );
+			}else{
+				return seq::util::newNull(anchor);
+			}
+
+		}
+	}
+
+	typedef seq::Generic(*ExprFunc)( bool, seq::type::Generic*, seq::type::Generic* );
+	typedef seq::Generic(*TypeFunc)( bool, seq::type::Generic*, seq::type::Generic*, byte op );
+
+#	define SQEFN [] ( bool f, seq::type::Generic* a, seq::type::Generic* b ) -> seq::Generic
+#	define SQTFN [] ( bool f, seq::type::Generic* a, seq::type::Generic* b, byte op ) -> seq::Generic
+#	define SQNML( g ) ((seq::type::Number*) g)->getLong()
+#	define SQNMD( g ) ((seq::type::Number*) g)->getDouble()
+#	define SQSTR( g ) ((seq::type::String*) g)->getString()
+#	define SQBOL( g ) ((seq::type::Bool*) g)->getBool()
+#	define SQTYP( g ) ((seq::type::Type*) g)->getType()
+
+	static const ExprFunc null_expr_func = SQEFN { return seq::Generic( seq::type::Null(f) ); };
+	static const TypeFunc null_type_func = SQTFN { return seq::Generic( seq::type::Null(f) ); };
+
+	static const ExprFunc expr_lambdas[SEQ_MAX_OPERATOR + 1][3] = {
+		{ // Padding
+			nullptr,
+			nullptr,
+			nullptr
+		},
+		{ // Less
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNMD(a) < SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) < SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Greater
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNMD(a) > SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) > SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Equal
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNMD(a) == SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) == SQBOL(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, a == b || SQSTR(a) == SQSTR(b)) ); },
+		},
+		{ // NotEqual
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNMD(a) != SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) != SQBOL(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, a != b && SQSTR(a) != SQSTR(b)) ); },
+		},
+		{ // NotGreater
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNMD(a) <= SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) <= SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // NotLess
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNMD(a) >= SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) >= SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // And
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNML(a) != 0 && SQNML(b) != 0) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) && SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Or
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNML(a) != 0 || SQNML(b) != 0) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) || SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Xor
+			SQEFN { return seq::Generic( seq::type::Bool(f, (SQNML(a) != 0) != (SQNML(b) != 0)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) != SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Not
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQNML(b) == 0) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, !SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Multiplication
+			SQEFN { return seq::Generic( seq::type::Number(f, SQNMD(a) * SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) < SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Division
+			SQEFN { return seq::Generic( seq::type::Number(f, SQNMD(a) / SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) < SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Addition
+			SQEFN { return seq::Generic( seq::type::Number(f, SQNMD(a) + SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) || SQBOL(b)) ); },
+			SQEFN { return seq::Generic( new seq::type::String(f, (SQSTR(a) + SQSTR(b)).c_str() ) ); },
+		},
+		{ // Subtraction
+			SQEFN { return seq::Generic( seq::type::Number(f, SQNMD(a) - SQNMD(b)) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) != SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Modulo
+			SQEFN { return seq::Generic( seq::type::Number(f, SQNML(a) % SQNML(b)) ); },
+			null_expr_func,
+			null_expr_func,
+		},
+		{ // Power
+			SQEFN { return seq::Generic( seq::type::Number(f, std::pow( SQNMD(a), SQNMD(b) )) ); },
+			null_expr_func,
+			null_expr_func,
+		},
+		{ // BinaryAnd
+			SQEFN { return seq::Generic( seq::type::Number(f, SQNML(a) & SQNML(b) ) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) && SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // BinaryOr
+			SQEFN { return seq::Generic( seq::type::Number(f, SQNML(a) | SQNML(b) ) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) || SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // BinaryXor
+			SQEFN { return seq::Generic( seq::type::Number(f, SQNML(a) ^ SQNML(b) ) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, SQBOL(a) != SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // BinaryNot
+			SQEFN { return seq::Generic( seq::type::Number(f, ~ SQNML(b) ) ); },
+			SQEFN { return seq::Generic( seq::type::Bool(f, !SQBOL(b)) ); },
+			null_expr_func,
+		},
+		{ // Accessor (handled in different place)
+			null_expr_func,
+			null_expr_func,
+			null_expr_func,
+		}
+	};
+
+	static const TypeFunc simple_null_type_func = SQTFN {
+		if( op == (byte) seq::ExprOperator::Equal ) return seq::Generic( seq::type::Bool( f, true ) );
+		if( op == (byte) seq::ExprOperator::NotEqual ) return seq::Generic( seq::type::Bool( f, false ) );
+		return seq::Generic( seq::type::Null( f ) );
+	};
+
+	static const TypeFunc simple_type_type_func = SQTFN {
+		if( op == (byte) seq::ExprOperator::Equal ) return seq::Generic( seq::type::Bool( f, SQTYP(a) == SQTYP(b) ) );
+		if( op == (byte) seq::ExprOperator::NotEqual ) return seq::Generic( seq::type::Bool( f, SQTYP(a) != SQTYP(b) ) );
+		return seq::Generic( seq::type::Null( f ) );
+	};
+
+	static const TypeFunc type_lambdas[SEQ_MAX_DATA_TYPE + 1] = {
+		/* 0 Padding */ nullptr,
+		/* 1  Bool   */ SQTFN { return expr_lambdas[op][1]( f, a, b ); },
+		/* 2  Null   */ simple_null_type_func,
+		/* 3  Number */ SQTFN { return expr_lambdas[op][0]( f, a, b ); },
+		/* 4  String */ SQTFN { return expr_lambdas[op][2]( f, a, b ); },
+		/* 5  Type   */ simple_type_type_func,
+		/* 6  VMCall */ null_type_func,
+		/* 7  Arg    */ null_type_func,
+		/* 8  Func   */ null_type_func,
+		/* 9  Expr   */ null_type_func,
+		/* 10 Name   */ null_type_func,
+		/* 11 Flowc  */ null_type_func,
+		/* 12 Stream */ null_type_func,
+		/* 13 Blob   */ null_type_func,
+	};
+
+	typedef seq::Generic(*IntFunc)( bool, int64_t, int64_t );
+
+#	define SQIFN [] ( bool f, int64_t a, int64_t b ) -> seq::Generic
+#	define SQINT( value ) seq::Generic( seq::type::Number(f, (value), 1) )
+#	define SQOVF( op, a, b, r ) !seq::util::naturalOperation( seq::ExprOperator::op, a, b, r )
+
+	// exact operations on natural numbers, nullptr means there is none
+	static const IntFunc int_lambdas[SEQ_MAX_OPERATOR + 1] = {
+		/* 0  Padding        */ nullptr,
+		/* 1  Less           */ SQIFN { return seq::Generic( seq::type::Bool(f, a < b) ); },
+		/* 2  Greater        */ SQIFN { return seq::Generic( seq::type::Bool(f, a > b) ); },
+		/* 3  Equal          */ SQIFN { return seq::Generic( seq::type::Bool(f, a == b) ); },
+		/* 4  NotEqual       */ SQIFN { return seq::Generic( seq::type::Bool(f, a != b) ); },
+		/* 5  NotGreater     */ SQIFN { return seq::Generic( seq::type::Bool(f, a <= b) ); },
+		/* 6  NotLess        */ SQIFN { return seq::Generic( seq::type::Bool(f, a >= b) ); },
+		/* 7  And            */ SQIFN { return seq::Generic( seq::type::Bool(f, a != 0 && b != 0) ); },
+		/* 8  Or             */ SQIFN { return seq::Generic( seq::type::Bool(f, a != 0 || b != 0) ); },
+		/* 9  Xor            */ SQIFN { return seq::Generic( seq::type::Bool(f, (a != 0) != (b != 0)) ); },
+		/* 10 Not            */ SQIFN { return seq::Generic( seq::type::Bool(f, b == 0) ); },
+		/* 11 Multiplication */ SQIFN { int64_t r; return SQOVF( Multiplication, a, b, r ) ? seq::Generic( seq::type::Number(f, (double) a * (double) b) ) : SQINT( r ); },
+		/* 12 Division       */ SQIFN { int64_t r; return SQOVF( Division, a, b, r ) ? seq::Generic( seq::type::Number(f, (double) a / (double) b) ) : SQINT( r ); },
+		/* 13 Addition       */ SQIFN { int64_t r; return SQOVF( Addition, a, b, r ) ? seq::Generic( seq::type::Number(f, (double) a + (double) b) ) : SQINT( r ); },
+		/* 14 Subtraction    */ SQIFN { int64_t r; return SQOVF( Subtraction, a, b, r ) ? seq::Generic( seq::type::Number(f, (double) a - (double) b) ) : SQINT( r ); },
+		/* 15 Modulo         */ SQIFN { return SQINT( ( b == -1 ) ? 0 : a % b ); },
+		/* 16 Power          */ nullptr,
+		/* 17 BinaryAnd      */ SQIFN { return SQINT( a & b ); },
+		/* 18 BinaryOr       */ SQIFN { return SQINT( a | b ); },
+		/* 19 BinaryXor      */ SQIFN { return SQINT( a ^ b ); },
+		/* 20 BinaryNot      */ SQIFN { return SQINT( ~ b ); },
+		/* 21 Accessor       */ nullptr
+	};
+
+#	undef SQEFN
+#	undef SQTFN
+#	undef SQIFN
+#	undef SQINT
+#	undef SQOVF
+#	undef SQNML
+#	undef SQNMD
+#	undef SQSTR
+#	undef SQBOL
+#	undef SQTYP
+
+	// use exact integer operations if both numbers are natural
+	if( ltype == seq::DataType::Number && rtype == seq::DataType::Number && int_lambdas[ (byte) op ] != nullptr ) {
+		seq::type::Number& a = left.Number();
+		seq::type::Number& b = right.Number();
+
+		if( a.isNatural() && b.isNatural() ) {
+			return int_lambdas[ (byte) op ]( anchor, a.getLong(), b.getLong() );
+		}
+	}
+
+	return type_lambdas[ (byte) rtype ]( anchor, left.getRaw(), right.getRaw(), (byte) op );
+
+}
+
+seq::Generic seq::Executor::executeExpr( seq::Generic& entity ) {
+
+	// get entity properties
+	seq::DataType type = entity.getDataType();
+	bool anchor = entity.getAnchor();
+
+	// if given entity is an expression pass it to executeExprPair
+	if( type == seq::DataType::Expr ) {
+		auto& expr = entity.Expression();
+
+#		ifdef SEQ_JIT_NATIVE
+		if( this->jitEnabled ) {
+			seq::Generic result;
+			if( this->executeNative( expr, anchor, result ) ) return result;
+		}
+#		endif
+
+		// the operands are decoded only once per program
+		return this->executeTree( this->getTree( expr ), 0, anchor );
+	}
+
+	// if it is simple argument resolve it's value
+	if( type == seq::DataType::Arg ) {
+		auto& arg = entity.Arg();
+
+		// get stack level to which the argument is referring
+		long s = (long) this->stack.size() - 1L - (long) arg.getLevel();
+
+		// according to Sequensa specification
+		// if argument reference is invalid null should be returned instead
+		if( s < 0 ) {
+			return seq::util::newNull( anchor );
+		}
+
+		// return stack argument
+		auto ret = this->stack[s].getArg();
+		ret.setAnchor(anchor);
+		return ret;
+	}
+
+	// else: return unchanged
+	return entity;
+
+}
+
+seq::Generic seq::Executor::executeTree( std::vector<seq::ExprNode>& tree, unsigned int index, bool anchor ) {
+
+	seq::ExprNode& node = tree[index];
+
+	switch( node.kind ) {
+
+		case seq::ExprNode::Kind::Value:
+			return node.value;
+
+		case seq::ExprNode::Kind::Arg:
+			return this->executeExpr( node.value );
+
+		case seq::ExprNode::Kind::Pair:
+			break;
+
+	}
+
+	// numeric operands are computed without creating intermediate generics
+	if( tree[node.left].numeric && tree[node.right].numeric ) {
+		seq::ExprNode::Scalar a, b;
+
+		if( node.numeric ) {
+			if( this->executeNumber( tree, index, a ) ) {
+				return seq::Generic( a.natural ? seq::type::Number( anchor, a.integer, 1 ) : seq::type::Number( anchor, a.real ) );
+			}
+		}else if( (byte) node.op <= (byte) seq::ExprOperator::NotLess ) {
+			if( this->executeNumber( tree, node.left, a ) && this->executeNumber( tree, node.right, b ) ) {
+				const bool natural = a.natural && b.natural;
+				bool value = false;
+
+				switch( node.op ) {
+					case seq::ExprOperator::Less: value = natural ? a.integer < b.integer : a.real < b.real; break;
+					case seq::ExprOperator::Greater: value = natural ? a.integer > b.integer : a.real > b.real; break;
+					case seq::ExprOperator::Equal: value = natural ? a.integer == b.integer : a.real == b.real; break;
+					case seq::ExprOperator::NotEqual: value = natural ? a.integer != b.integer : a.real != b.real; break;
+					case seq::ExprOperator::NotGreater: value = natural ? a.integer <= b.integer : a.real <= b.real; break;
+					case seq::ExprOperator::NotLess: value = natural ? a.integer >= b.integer : a.real >= b.real; break;
+					default: break;
+				}
+
+				return seq::util::newBool( value, anchor );
+			}
+		}
+	}
+
+	// operands of other types (or invalid arguments) take the generic path
+	return this->executeExprPair( this->executeTree( tree, node.left, false ), this->executeTree( tree, node.right, false ), node.op, anchor );
+
+}
+
+bool seq::Executor::executeNumber( std::vector<seq::ExprNode>& tree, unsigned int index, seq::ExprNode::Scalar& number ) {
+
+	seq::ExprNode& node = tree[index];
+
+	if( node.kind != seq::ExprNode::Kind::Pair ) {
+		seq::Generic value;
+
+		if( node.kind == seq::ExprNode::Kind::Arg ) {
+			long s = (long) this->stack.size() - 1L - (long) node.value.Arg().getLevel();
+
+			if( s < 0 ) {
+				return false;
+			}
+
+			value = this->stack[s].getArg();
+
+			if( value.getDataType() != seq::DataType::Number ) {
+				return false;
+			}
+		}
+
+		seq::type::Number& num = ( node.kind == seq::ExprNode::Kind::Value ) ? node.value.Number() : value.Number();
+		number.natural = num.isNatural();
+		number.integer = num.getLong();
+		number.real = num.getDouble();
+		return true;
+	}
+
+	seq::ExprNode::Scalar right;
+
+	if( !this->executeNumber( tree, node.left, number ) || !this->executeNumber( tree, node.right, right ) ) {
+		return false;
+	}
+
+	// same rules as in executeExprPair, integers are used as long as the result is exact
+	if( number.natural && right.natural && seq::util::naturalOperation( node.op, number.integer, right.integer, number.integer ) ) {
+		number.real = (double) number.integer;
+		return true;
+	}
+
+	switch( node.op ) {
+		case seq::ExprOperator::Multiplication: number.real = number.real * right.real; break;
+		case seq::ExprOperator::Division: number.real = number.real / right.real; break;
+		case seq::ExprOperator::Addition: number.real = number.real + right.real; break;
+		case seq::ExprOperator::Subtraction: number.real = number.real - right.real; break;
+		default: return false;
+	}
+
+	// the result can still turn out to be a natural number
+	seq::type::Number result( false, number.real );
+	number.natural = result.isNatural();
+	number.integer = result.getLong();
+	return true;
+
+}
+
+std::vector<seq::ExprNode>& seq::Executor::getTree( seq::type::Expression& expr ) {
+
+	// expressions share keys with the native code
+	const byte* key = expr.getLeftReader().bytes();
+	auto it = this->trees.find( key );
+
+	if( it != this->trees.end() ) {
+		return it->second;
+	}
+
+	std::vector<seq::ExprNode>& tree = this->trees[ key ];
+	tree.reserve( 3 );
+	tree.emplace_back();
+	tree[0].kind = seq::ExprNode::Kind::Pair;
+	tree[0].op = expr.getOperator();
+
+	// copy readers, the expression itself can be shared
+	seq::BufferReader lbr = expr.getLeftReader();
+	seq::BufferReader rbr = expr.getRightReader();
+
+	const unsigned int left = this->buildTree( tree, lbr.next().getGeneric() );
+	const unsigned int right = this->buildTree( tree, rbr.next().getGeneric() );
+
+	tree[0].left = left;
+	tree[0].right = right;
+	tree[0].numeric = tree[left].numeric && tree[right].numeric && (byte) tree[0].op >= (byte) seq::ExprOperator::Multiplication && (byte) tree[0].op <= (byte) seq::ExprOperator::Subtraction;
+
+	return tree;
+
+}
+
+unsigned int seq::Executor::buildTree( std::vector<seq::ExprNode>& tree, seq::Generic entity ) {
+
+	const unsigned int index = (unsigned int) tree.size();
+	tree.emplace_back();
+
+	switch( entity.getDataType() ) {
+
+		case seq::DataType::Expr: {
+				auto& expr = entity.Expression();
+
+				// copy readers, the expression itself can be shared
+				seq::BufferReader lbr = expr.getLeftReader();
+				seq::BufferReader rbr = expr.getRightReader();
+
+				// the vector can be reallocated by the recursive calls
+				const unsigned int left = this->buildTree( tree, lbr.next().getGeneric() );
+				const unsigned int right = this->buildTree( tree, rbr.next().getGeneric() );
+				const seq::ExprOperator op = expr.getOperator();
+
+				tree[index].kind = seq::ExprNode::Kind::Pair;
+				tree[index].op = op;
+				tree[index].left = left;
+				tree[index].right = right;
+				tree[index].numeric = tree[left].numeric && tree[right].numeric && (byte) op >= (byte) seq::ExprOperator::Multiplication && (byte) op <= (byte) seq::ExprOperator::Subtraction;
+			}
+			break;
+
+		case seq::DataType::Arg:
+			tree[index].kind = seq::ExprNode::Kind::Arg;
+			tree[index].numeric = true;
+			tree[index].value = std::move( entity );
+			break;
+
+		default:
+			this->internString( entity );
+			tree[index].kind = seq::ExprNode::Kind::Value;
+			tree[index].numeric = ( entity.getDataType() == seq::DataType::Number );
+			tree[index].value = std::move( entity );
+			break;
+
+	}
+
+	return index;
+
+}
+
+bool seq::Executor::executeBatch( seq::type::Function& func, seq::Stream& input_stream, seq::Stream& output ) {
+
+	seq::Generic* expr = this->getBatch( func.getReader() );
+	std::vector<double> values;
+
+	if( expr == nullptr || !seq::util::packNumbers( input_stream, values ) ) {
+		return false;
+	}
+
+	std::vector<seq::ExprNode>& tree = this->getTree( expr->Expression() );
+	const size_t count = values.size();
+
+	// floating point arithmetic matches the exact integer arithmetic
+	// only as long as all integers can be represented by a double
+	if( this->boundTree( tree, 0, seq::util::batchBound( values.data(), count ) ) == INFINITY ) {
+		return false;
+	}
+
+	std::vector<double> result( count );
+	this->executeBatchTree( tree, 0, values.data(), result.data(), count );
+
+	output.reserve( count );
+	for( double value : result ) {
+		output.push_back( seq::util::newNumber( value ) );
+	}
+
+	return true;
+
+}
+
+void seq::Executor::executeBatchTree( std::vector<seq::ExprNode>& tree, unsigned int index, const double* input, double* output, size_t count ) {
+
+	seq::ExprNode& node = tree[index];
+
+	switch( node.kind ) {
+
+		case seq::ExprNode::Kind::Value:
+			std::fill( output, output + count, node.value.Number().getDouble() );
+			break;
+
+		case seq::ExprNode::Kind::Arg:
+			std::copy( input, input + count, output );
+			break;
+
+		case seq::ExprNode::Kind::Pair: {
+				std::vector<double> right( count );
+				this->executeBatchTree( tree, node.left, input, output, count );
+				this->executeBatchTree( tree, node.right, input, right.data(), count );
+				seq::util::batchOperation( node.op, output, right.data(), output, count );
+			}
+			break;
+
+	}
+
+}
+
+double seq::Executor::boundTree( std::vector<seq::ExprNode>& tree, unsigned int index, double bound ) {
+
+	seq::ExprNode& node = tree[index];
+
+	if( node.kind == seq::ExprNode::Kind::Value ) {
+		return std::abs( node.value.Number().getDouble() );
+	}
+
+	if( node.kind == seq::ExprNode::Kind::Arg ) {
+		return bound;
+	}
+
+	const double left = this->boundTree( tree, node.left, bound );
+	const double right = this->boundTree( tree, node.right, bound );
+	double result = INFINITY;
+
+	switch( node.op ) {
+		case seq::ExprOperator::Multiplication: result = left * right; break;
+		case seq::ExprOperator::Addition: result = left + right; break;
+		case seq::ExprOperator::Subtraction: result = left + right; break;
+
+		// quotient is only bounded if the divisor is known not to be a fraction
+		case seq::ExprOperator::Division:
+			if( tree[node.right].kind == seq::ExprNode::Kind::Value && right >= 1 ) result = left;
+			break;
+
+		default: break;
+	}
+
+	return ( result < 9007199254740992.0 ) ? result : INFINITY;
+
+}
+
+seq::Generic* seq::Executor::getBatch( seq::BufferReader& reader ) {
+
+	// functions are identified by the address of their body, like decoded bodies
+	const byte* key = reader.bytes();
+	auto it = this->batches.find( key );
+
+	if( it != this->batches.end() ) {
+		return it->second;
+	}
+
+	seq::Generic* expr = nullptr;
+	seq::Stream& body = this->decode( reader );
+
+	// only bodies in form of `{ #return << (expression) }` are supported, where
+	// the expression uses only numbers, arithmetic operators and the @ argument
+	if( body.size() == 1 && body[0].getDataType() == seq::DataType::Stream && ( body[0].Stream().getTags() & ~SEQ_TAG_TAIL ) == 0 ) {
+		seq::Stream& stream = this->decode( body[0].Stream().getReader() );
+
+		if( stream.size() == 2 && stream[0].getDataType() == seq::DataType::VMCall && stream[0].getAnchor() && stream[0].VMCall().getCall() == seq::type::VMCall::CallType::Return ) {
+			if( stream[1].getDataType() == seq::DataType::Expr && !stream[1].getAnchor() ) {
+				std::vector<seq::ExprNode>& tree = this->getTree( stream[1].Expression() );
+				bool valid = tree[0].numeric;
+
+				for( auto& node : tree ) {
+					if( node.kind == seq::ExprNode::Kind::Arg && node.value.Arg().getLevel() != 0 ) valid = false;
+				}
+
+				if( valid ) expr = &stream[1];
+			}
+		}
+	}
+
+	this->batches[ key ] = expr;
+	return expr;
+
+}
+
+seq::Stream seq::Executor::resolveName( std::string& name, bool anchor ) {
+
+	const unsigned int slot = this->intern( name );
+
+	// iterate stack levels in search of the specified variable
+	for( int i = (int) this->stack.size() - 1; i >= 0; i -- ) {
+
+		auto& level = this->stack[i];
+
+		if( level.hasSlot( slot ) ) {
+			return level.getSlot( slot, anchor );
+		}
+
+		if( level.hasVar( name ) ) {
+			return level.getVar( name, anchor );
+		}
+
+	}
+
+	// if executor has a parent, ask him
+	if( parent != nullptr ) {
+		return parent->resolveName( name, anchor );
+	}
+
+	// if symbol wasn't found throw runtime exception
+	throw seq::RuntimeError( "Referenced undefined symbol: '" + name + "'" );
+
+}
+
+void seq::Executor::defineName( std::string& name, Stream&& value, bool define ) {
+
+	const unsigned int slot = this->intern( name );
+
+	// iterate stack levels in search of the specified variable
+	for( int i = (int) this->stack.size() - 1; i >= 0; i -- ) {
+
+		auto& level = this->stack[i];
+
+		// when it's found modify current value
+		if( level.hasSlot( slot ) ) {
+			level.setSlot( slot, std::move( value ) );
+			return;
+		}
+
+		if( level.hasVar( name ) ) {
+			level.setVar( name, std::move( value ) );
+			return;
+		}
+
 	}
 
-	if( type == seq::DataType::Blob ) {
-		throw seq::RuntimeError( "Invalid '" + entity.Blob().toString() + "' call!" );
+	// if executor has a parent, ask him
+	if( parent != nullptr ) {
+		return parent->defineName( name, std::move( value ), false );
 	}
 
-	// if not any of the above, simply cast args to anchor
-	seq::Stream output_stream;
-	for( auto& g : input_stream ) {
-		output_stream.push_back( this->executeCast( entity, g ) );
+	// if symbol wasn't found create new variable in top stack level
+	if( define ) {
+		getTopLevel()->setSlot( slot, std::move( value ) );
+	}
+
+}
+
+unsigned int seq::Executor::resolveSlot( seq::type::Name& name ) {
+
+	// names loaded from the bytecode are interned once per program, and
+	// looked up by their address after that, other names are always interned
+	const byte* origin = name.getOrigin();
+
+	if( origin == nullptr ) {
+		return this->intern( name.getName() );
+	}
+
+	auto it = this->names.find( origin );
+
+	if( it != this->names.end() ) {
+		return it->second;
+	}
+
+	const unsigned int slot = this->intern( name.getName() );
+	this->names.emplace( origin, slot );
+	return slot;
+
+}
+
+unsigned int seq::Executor::intern( const std::string& name ) {
+
+	// every name used by this executor gets its own slot
+	auto it = this->symbols.find( name );
+
+	if( it != this->symbols.end() ) {
+		return it->second;
+	}
+
+	return this->symbols.emplace( name, (unsigned int) this->symbols.size() ).first->second;
+
+}
+
+void seq::Executor::internString( seq::Generic& entity ) {
+
+	// equal string constants share a single value, so that they can be compared by identity
+	if( entity.getDataType() == seq::DataType::String && !entity.getAnchor() ) {
+		auto it = this->strings.find( entity.String().getString() );
+
+		if( it != this->strings.end() ) {
+			entity = it->second;
+		}else{
+			this->strings.emplace( entity.String().getString(), entity );
+		}
+	}
+
+}
+
+seq::Stream seq::Executor::resolveName( seq::type::Name& name, bool anchor ) {
+
+	const unsigned int slot = this->resolveSlot( name );
+
+	// iterate stack levels in search of the specified variable,
+	// variables set directly on a stack level can still be found by name
+	for( int i = (int) this->stack.size() - 1; i >= 0; i -- ) {
+
+		auto& level = this->stack[i];
+
+		if( level.hasSlot( slot ) ) {
+			return level.getSlot( slot, anchor );
+		}
+
+		if( level.hasVar( name.getName() ) ) {
+			return level.getVar( name.getName(), anchor );
+		}
+
+	}
+
+	// if executor has a parent, ask him
+	if( parent != nullptr ) {
+		return parent->resolveName( name.getName(), anchor );
+	}
+
+	// if symbol wasn't found throw runtime exception
+	throw seq::RuntimeError( "Referenced undefined symbol: '" + name.getName() + "'" );
+
+}
+
+void seq::Executor::defineName( seq::type::Name& name, Stream&& value ) {
+
+	const unsigned int slot = this->resolveSlot( name );
+
+	// iterate stack levels in search of the specified variable
+	for( int i = (int) this->stack.size() - 1; i >= 0; i -- ) {
+
+		auto& level = this->stack[i];
+
+		// when it's found modify current value
+		if( level.hasSlot( slot ) ) {
+			level.setSlot( slot, std::move( value ) );
+			return;
+		}
+
+		if( level.hasVar( name.getName() ) ) {
+			level.setVar( name.getName(), std::move( value ) );
+			return;
+		}
+
+	}
+
+	// if executor has a parent, ask him
+	if( parent != nullptr ) {
+		return parent->defineName( name.getName(), std::move( value ), false );
+	}
+
+	// if symbol wasn't found create new variable in top stack level
+	getTopLevel()->setSlot( slot, std::move( value ) );
+
+}
+
+seq::type::Native seq::Executor::resolveNative( std::string& name ) {
+
+	auto it = this->natives.find( name );
+
+	if( it != this->natives.end() ) {
+		return it->second;
+	}
+
+	if( parent != nullptr ) {
+		return parent->resolveNative( name );
+	}
+
+	// native was not found
+	return nullptr;
+
+}
+
+std::unordered_map<std::string, seq::type::Native>& seq::Executor::getNativesMap() {
+
+	// the map can be modified by the caller
+	this->invalidate();
+	return this->natives;
+
+}
+
+seq::type::Native seq::Executor::resolveCall( seq::type::Name& name, seq::Stream& stream ) {
+
+	// call sites are keyed by the address of their name in the bytecode,
+	// names that weren't loaded from bytecode are resolved every time
+	seq::CallSite none;
+	seq::CallSite& site = ( name.getOrigin() != nullptr ) ? this->sites[ name.getOrigin() ] : none;
+
+	// the call site was already resolved, and nothing has changed since
+	if( site.generation == this->generation ) {
+		if( site.native != nullptr ) {
+			return site.native;
+		}
+
+		if( site.level < this->stack.size() ) {
+			auto& level = this->stack[site.level];
+
+			if( level.hasSlot( site.slot ) ) {
+				stream = level.getSlot( site.slot, true );
+				return nullptr;
+			}
+		}
+	}
+
+	auto it = this->natives.find( name.getName() );
+
+	if( it != this->natives.end() ) {
+		site.generation = this->generation;
+		site.native = it->second;
+		return it->second;
+	}
+
+	// names resolved by the parent are not cached, as it can change them at any time
+	if( parent != nullptr ) {
+		seq::type::Native native = parent->resolveNative( name.getName() );
+		if( native == nullptr ) stream = this->resolveName( name, true );
+		return native;
+	}
+
+	const unsigned int slot = this->resolveSlot( name );
+
+	// variables found in a slot are cached by their stack level, `set` never hides an existing
+	// variable (it's modified instead), so as long as that level holds the slot it's still the one
+	// that would be found, unless the executor was changed by `define`, `inject` or `reset`
+	for( int i = (int) this->stack.size() - 1; i >= 0; i -- ) {
+
+		auto& level = this->stack[i];
+
+		if( level.hasSlot( slot ) ) {
+			site.generation = this->generation;
+			site.native = nullptr;
+			site.level = i;
+			site.slot = slot;
+
+			stream = level.getSlot( slot, true );
+			return nullptr;
+		}
+
+		if( level.hasVar( name.getName() ) ) {
+			stream = level.getVar( name.getName(), true );
+			return nullptr;
+		}
+
+	}
+
+	stream = this->resolveName( name, true );
+	return nullptr;
+
+}
+
+void seq::Executor::invalidate() {
+
+	// call sites resolved in an older generation resolve their names again
+	this->generation = unique();
+
+}
+
+void seq::Executor::releaseBuffer( size_t mark ) {
+
+	const std::pair<const byte*, const byte*> range = this->buffers.back();
+	this->buffers.pop_back();
+
+	// top level programs are kept until the next one starts,
+	// same for a buffer that is still executed by an outer program
+	if( this->depth == 0 ) {
+		return;
+	}
+
+	for( auto& buffer : this->buffers ) {
+		if( buffer.first < range.second && range.first < buffer.second ) return;
+	}
+
+	forget( this->decoded, range.first, range.second );
+	forget( this->bodies, range.first, range.second );
+	forget( this->lowered, range.first, range.second );
+	forget( this->functions, range.first, range.second );
+	forget( this->closures, range.first, range.second );
+	forget( this->caches, range.first, range.second );
+	forget( this->trees, range.first, range.second );
+	forget( this->batches, range.first, range.second );
+	forget( this->sites, range.first, range.second );
+	forget( this->names, range.first, range.second );
+#	ifdef SEQ_JIT_NATIVE
+	forget( this->nativeExprs, range.first, range.second );
+#	endif
+
+	// operations lowered from the nested program can be dropped,
+	// unless an outer function was lowered after them
+	for( auto& function : this->functions ) {
+		if( function.second >= mark ) return;
+	}
+
+	if( mark < this->operations.size() ) {
+		this->operations.erase( this->operations.begin() + mark, this->operations.end() );
+	}
+
+}
+
+template<typename T>
+void seq::Executor::forget( std::unordered_map<const byte*, T>& map, const byte* first, const byte* last ) {
+
+	for( auto it = map.begin(); it != map.end(); ) {
+		if( it->first >= first && it->first < last ) {
+			it = map.erase( it );
+		}else{
+			it ++;
+		}
+	}
+
+}
+
+unsigned long seq::Executor::unique() {
+
+	static std::atomic<unsigned long> counter( 0 );
+	return ++ counter;
+
+}
+
+seq::Stream& seq::Executor::decode( seq::BufferReader& reader ) {
+
+	// bodies are identified by the address of their first byte
+	const byte* key = reader.bytes();
+	auto it = this->decoded.find( key );
+
+	if( it != this->decoded.end() ) {
+		return it->second;
+	}
+
+	// decode using a copy, so that the given reader is left untouched
+	seq::BufferReader br = reader;
+	seq::Stream& stream = this->decoded.emplace( key, br.readAll() ).first->second;
+
+	for( seq::Generic& entity : stream ) {
+		this->internString( entity );
+	}
+
+	return stream;
+
+}
+
+bool seq::Executor::isClosed( seq::BufferReader& reader ) {
+
+	// closures share keys with the decoded bodies
+	const byte* key = reader.bytes();
+	auto it = this->closures.find( key );
+
+	if( it != this->closures.end() ) {
+		return it->second;
+	}
+
+	const bool closed = this->isClosed( this->decode( reader ), 0 );
+	this->closures[ key ] = closed;
+	return closed;
+
+}
+
+bool seq::Executor::isClosed( seq::Stream& body, int depth ) {
+
+	// check if any argument refers to a stack level above the function
+	for( seq::Generic& entity : body ) {
+		switch( entity.getDataType() ) {
+
+			case seq::DataType::Arg:
+				if( entity.Arg().getLevel() > depth ) return false;
+				break;
+
+			case seq::DataType::Expr: {
+					seq::BufferReader lbr = entity.Expression().getLeftReader();
+					seq::BufferReader rbr = entity.Expression().getRightReader();
+					seq::Stream operands = { lbr.next().getGeneric(), rbr.next().getGeneric() };
+
+					if( !this->isClosed( operands, depth ) ) return false;
+				}
+				break;
+
+			case seq::DataType::Stream:
+				if( !this->isClosed( this->decode( entity.Stream().getReader() ), depth ) ) return false;
+				break;
+
+			case seq::DataType::Func:
+				if( !this->isClosed( this->decode( entity.Function().getReader() ), depth + 1 ) ) return false;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return true;
+
+}
+
+bool seq::Executor::isPure( seq::Stream& body, int depth, std::vector<std::string>& names ) {
+
+	// the result of a pure function only depends on its argument
+	// and the functions it calls, those are collected in `names`
+	for( seq::Generic& entity : body ) {
+		switch( entity.getDataType() ) {
+
+			case seq::DataType::Arg:
+				if( entity.Arg().getLevel() > depth ) return false;
+				break;
+
+			case seq::DataType::Name: {
+					auto& name = entity.Name();
+
+					// variables can be both read and set outside of the function
+					if( !entity.getAnchor() || name.getDefine() ) return false;
+
+					if( std::find( names.begin(), names.end(), name.getName() ) == names.end() ) {
+						names.push_back( name.getName() );
+					}
+				}
+				break;
+
+			case seq::DataType::Expr: {
+					if( entity.Expression().getOperator() == seq::ExprOperator::Accessor ) return false;
+
+					seq::BufferReader lbr = entity.Expression().getLeftReader();
+					seq::BufferReader rbr = entity.Expression().getRightReader();
+					seq::Stream operands = { lbr.next().getGeneric(), rbr.next().getGeneric() };
+
+					if( !this->isPure( operands, depth, names ) ) return false;
+				}
+				break;
+
+			case seq::DataType::Stream:
+				if( !this->isPure( this->decode( entity.Stream().getReader() ), depth, names ) ) return false;
+				break;
+
+			case seq::DataType::Func:
+				if( !this->isPure( this->decode( entity.Function().getReader() ), depth + 1, names ) ) return false;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	return true;
+
+}
+
+void seq::Executor::linkNames( seq::Stream& body, std::vector<std::string>& called, std::unordered_set<std::string>& defined ) {
+
+	for( seq::Generic& entity : body ) {
+		switch( entity.getDataType() ) {
+
+			case seq::DataType::Name: {
+					auto& name = entity.Name();
+
+					if( name.getDefine() ) {
+						defined.insert( name.getName() );
+					}else if( entity.getAnchor() && std::find( called.begin(), called.end(), name.getName() ) == called.end() ) {
+						called.push_back( name.getName() );
+					}
+				}
+				break;
+
+			case seq::DataType::Expr: {
+					seq::BufferReader lbr = entity.Expression().getLeftReader();
+					seq::BufferReader rbr = entity.Expression().getRightReader();
+					seq::Stream operands = { lbr.next().getGeneric(), rbr.next().getGeneric() };
+
+					this->linkNames( operands, called, defined );
+				}
+				break;
+
+			case seq::DataType::Stream:
+				this->linkNames( this->decode( entity.Stream().getReader() ), called, defined );
+				break;
+
+			case seq::DataType::Func:
+				this->linkNames( this->decode( entity.Function().getReader() ), called, defined );
+				break;
+
+			default:
+				break;
+		}
+	}
+
+}
+
+bool seq::Executor::hasName( std::string& name ) {
+
+	auto it = this->symbols.find( name );
+	long slot = ( it == this->symbols.end() ) ? -1 : (long) it->second;
+
+	for( size_t i = 0; i < this->stack.size(); i ++ ) {
+		auto& level = this->stack[i];
+		if( ( slot != -1 && level.hasSlot( slot ) ) || level.hasVar( name ) ) return true;
+	}
+
+	return this->parent != nullptr && this->parent->hasName( name );
+
+}
+
+bool seq::Executor::resolveBindings( seq::FunctionCache& cache, std::vector<const byte*>& bindings ) {
+
+	std::vector<seq::FunctionCache*> pending = { &cache };
+
+	// all functions called (directly or not) by a pure function must also be pure
+	for( size_t i = 0; i < pending.size(); i ++ ) {
+		for( std::string& name : pending[i]->names ) {
+
+			if( this->resolveNative( name ) != nullptr || !this->hasName( name ) ) {
+				return false;
+			}
+
+			seq::Stream value = this->resolveName( name, false );
+			if( value.size() != 1 || value[0].getDataType() != seq::DataType::Func ) {
+				return false;
+			}
+
+			seq::BufferReader& reader = value[0].Function().getReader();
+			if( std::find( bindings.begin(), bindings.end(), reader.bytes() ) != bindings.end() ) {
+				continue;
+			}
+
+			bindings.push_back( reader.bytes() );
+			seq::FunctionCache& callee = this->getCache( reader );
+
+			if( !callee.pure ) {
+				return false;
+			}
+
+			pending.push_back( &callee );
+		}
 	}
-	return CommandResult( seq::CommandResult::ResultType::None, std::move(output_stream) );
+
+	return true;
 
 }
 
-seq::Generic seq::Executor::executeExprPair( seq::Generic left, seq::Generic right, seq::ExprOperator op, bool anchor ) {
+seq::FunctionCache& seq::Executor::getCache( seq::BufferReader& reader ) {
 
-	{
-		const seq::DataType ltype = left.getDataType();
-		const seq::DataType rtype = right.getDataType();
+	// caches share keys with the decoded bodies
+	const byte* key = reader.bytes();
+	auto it = this->caches.find( key );
 
-		// if left or right side is and expr or arg pass it through executeExpr
-		if( ltype == seq::DataType::Expr || ltype == seq::DataType::Arg ) left = this->executeExpr(left);
-		if( rtype == seq::DataType::Expr || rtype == seq::DataType::Arg ) right = this->executeExpr(right);
+	if( it != this->caches.end() ) {
+		return it->second;
 	}
 
-	const seq::DataType ltype = left.getDataType();
-	const seq::DataType rtype = right.getDataType();
+	std::vector<std::string> names;
+	const bool pure = this->isPure( this->decode( reader ), 0, names );
+	return this->caches.emplace( key, seq::FunctionCache( pure, std::move( names ) ) ).first->second;
 
-	// handle accessor operator
-	if( op == seq::ExprOperator::Accessor ) {
+}
 
-		if( ltype != seq::DataType::Name || rtype != seq::DataType::Number ) {
-			throw seq::RuntimeError( "Invalid accessor operands, stream and number expected!" );
-		}
+seq::FunctionBody& seq::Executor::getBody( seq::BufferReader& reader ) {
 
-		// try returning element from stream (left) at index (right)
-		try{
-			const Stream stream = this->resolveName( left.Name().getName(), anchor );
-			return stream.at( right.Number().getLong() );
-		}catch( std::out_of_range& err ){
-			return seq::util::newNull(anchor);
-		}
+	// bodies share keys with the decoded streams
+	const byte* key = reader.bytes();
+	auto it = this->bodies.find( key );
 
+	if( it != this->bodies.end() ) {
+		return it->second;
 	}
 
-	// return null if data types don't match (with exception of Not and BinaryNot)
-	if( rtype != ltype ) {
-		if( op != seq::ExprOperator::Not && op != seq::ExprOperator::BinaryNot ) {
+	return this->bodies.emplace( key, seq::FunctionBody( this->decode( reader ) ) ).first->second;
 
-			if( this->strictMath ) {
-				throw seq::RuntimeError( "Expression operators don't match!" );
-			}else{
-				return seq::util::newNull(anchor);
-			}
+}
 
-		}
-	}
+seq::Instruction* seq::Executor::lower( seq::BufferReader& reader ) {
 
-	typedef seq::type::Generic*(*ExprFunc)( bool, seq::type::Generic*, seq::type::Generic* );
-	typedef seq::type::Generic*(*TypeFunc)( bool, seq::type::Generic*, seq::type::Generic*, byte op );
+	// lowered streams share keys with the decoded ones
+	const byte* key = reader.bytes();
+	auto it = this->lowered.find( key );
 
-#	define SQEFN [] ( bool f, seq::type::Generic* a, seq::type::Generic* b ) -> seq::type::Generic*
-#	define SQTFN [] ( bool f, seq::type::Generic* a, seq::type::Generic* b, byte op ) -> seq::type::Generic*
-#	define SQNML( g ) ((seq::type::Number*) g)->getLong()
-#	define SQNMD( g ) ((seq::type::Number*) g)->getDouble()
-#	define SQSTR( g ) ((seq::type::String*) g)->getString()
-#	define SQBOL( g ) ((seq::type::Bool*) g)->getBool()
-#	define SQTYP( g ) ((seq::type::Type*) g)->getType()
+	if( it != this->lowered.end() ) {
+		return it->second.data();
+	}
 
-	static const ExprFunc null_expr_func = SQEFN { return new seq::type::Null(f); };
-	static const TypeFunc null_type_func = SQTFN { return new seq::type::Null(f); };
+	seq::Stream& stream = this->decode( reader );
+	std::vector<seq::Instruction> code;
+	code.reserve( stream.size() + 1 );
 
-	static const ExprFunc expr_lambdas[SEQ_MAX_OPERATOR + 1][3] = {
-		{ // Padding
-			nullptr,
-			nullptr,
-			nullptr
-		},
-		{ // Less
-			SQEFN { return new seq::type::Bool(f, SQNMD(a) < SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) < SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Greater
-			SQEFN { return new seq::type::Bool(f, SQNMD(a) > SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) > SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Equal
-			SQEFN { return new seq::type::Bool(f, SQNMD(a) == SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) == SQBOL(b)); },
-			SQEFN { return new seq::type::Bool(f, SQSTR(a) == SQSTR(b)); },
-		},
-		{ // NotEqual
-			SQEFN { return new seq::type::Bool(f, SQNMD(a) != SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) != SQBOL(b)); },
-			SQEFN { return new seq::type::Bool(f, SQSTR(a) != SQSTR(b)); },
-		},
-		{ // NotGreater
-			SQEFN { return new seq::type::Bool(f, SQNMD(a) <= SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) <= SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // NotLess
-			SQEFN { return new seq::type::Bool(f, SQNMD(a) >= SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) >= SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // And
-			SQEFN { return new seq::type::Bool(f, SQNML(a) != 0 && SQNML(b) != 0); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) && SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Or
-			SQEFN { return new seq::type::Bool(f, SQNML(a) != 0 || SQNML(b) != 0); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) || SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Xor
-			SQEFN { return new seq::type::Bool(f, (SQNML(a) != 0) != (SQNML(b) != 0)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) != SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Not
-			SQEFN { return new seq::type::Bool(f, SQNML(b) == 0); },
-			SQEFN { return new seq::type::Bool(f, !SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Multiplication
-			SQEFN { return new seq::type::Number(f, SQNMD(a) * SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) < SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Division
-			SQEFN { return new seq::type::Number(f, SQNMD(a) / SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) < SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Addition
-			SQEFN { return new seq::type::Number(f, SQNMD(a) + SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) || SQBOL(b)); },
-			SQEFN { return new seq::type::String(f, (SQSTR(a) + SQSTR(b)).c_str() ); },
-		},
-		{ // Subtraction
-			SQEFN { return new seq::type::Number(f, SQNMD(a) - SQNMD(b)); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) != SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Modulo
-			SQEFN { return new seq::type::Number(f, SQNML(a) % SQNML(b)); },
-			null_expr_func,
-			null_expr_func,
-		},
-		{ // Power
-			SQEFN { return new seq::type::Number(f, std::pow( SQNMD(a), SQNMD(b) )); },
-			null_expr_func,
-			null_expr_func,
-		},
-		{ // BinaryAnd
-			SQEFN { return new seq::type::Number(f, SQNML(a) & SQNML(b) ); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) && SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // BinaryOr
-			SQEFN { return new seq::type::Number(f, SQNML(a) | SQNML(b) ); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) || SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // BinaryXor
-			SQEFN { return new seq::type::Number(f, SQNML(a) ^ SQNML(b) ); },
-			SQEFN { return new seq::type::Bool(f, SQBOL(a) != SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // BinaryNot
-			SQEFN { return new seq::type::Number(f, ~ SQNML(b) ); },
-			SQEFN { return new seq::type::Bool(f, !SQBOL(b)); },
-			null_expr_func,
-		},
-		{ // Accessor (handled in different place)
-			null_expr_func,
-			null_expr_func,
-			null_expr_func,
-		}
-	};
+	// streams are evaluated from right to left, so the instructions are emitted in that order,
+	// operands point into the decoded stream, which lives as long as the lowered one
+	for( long i = (long) stream.size() - 1; i >= 0; i -- ) {
+		code.push_back( { nullptr, &stream[i], seq::Instruction::classify( stream[i] ) } );
+	}
 
-	static const TypeFunc simple_null_type_func = SQTFN {
-		if( op == (byte) seq::ExprOperator::Equal ) return new seq::type::Bool( f, true );
-		if( op == (byte) seq::ExprOperator::NotEqual ) return new seq::type::Bool( f, false );
-		return new seq::type::Null( f );
-	};
+	code.push_back( { nullptr, nullptr, seq::Instruction::Op::End } );
+	return this->lowered.emplace( key, std::move( code ) ).first->second.data();
 
-	static const TypeFunc simple_type_type_func = SQTFN {
-		if( op == (byte) seq::ExprOperator::Equal ) return new seq::type::Bool( f, SQTYP(a) == SQTYP(b) );
-		if( op == (byte) seq::ExprOperator::NotEqual ) return new seq::type::Bool( f, SQTYP(a) != SQTYP(b) );
-		return new seq::type::Null( f );
-	};
+}
 
-	static const TypeFunc type_lambdas[SEQ_MAX_DATA_TYPE + 1] = {
-		/* 0 Padding */ nullptr,
-		/* 1  Bool   */ SQTFN { return expr_lambdas[op][1]( f, a, b ); },
-		/* 2  Null   */ simple_null_type_func,
-		/* 3  Number */ SQTFN { return expr_lambdas[op][0]( f, a, b ); },
-		/* 4  String */ SQTFN { return expr_lambdas[op][2]( f, a, b ); },
-		/* 5  Type   */ simple_type_type_func,
-		/* 6  VMCall */ null_type_func,
-		/* 7  Arg    */ null_type_func,
-		/* 8  Func   */ null_type_func,
-		/* 9  Expr   */ null_type_func,
-		/* 10 Name   */ null_type_func,
-		/* 11 Flowc  */ null_type_func,
-		/* 12 Stream */ null_type_func,
-		/* 13 Blob   */ null_type_func,
-	};
+unsigned int seq::Executor::lowerFunction( seq::BufferReader& reader ) {
 
-#	undef SQEFN
-#	undef SQTFN
-#	undef SQNML
-#	undef SQNMD
-#	undef SQSTR
-#	undef SQBOL
-#	undef SQTYP
+	// functions are identified by the address of their body
+	const byte* key = reader.bytes();
+	auto it = this->functions.find( key );
 
-	return seq::Generic( type_lambdas[ (byte) rtype ]( anchor, left.getRaw(), right.getRaw(), (byte) op ) );
+	if( it != this->functions.end() ) {
+		return it->second;
+	}
 
-}
+	// nested functions are lowered after this one, so that its operations stay contiguous
+	std::vector<std::pair<unsigned int, seq::BufferReader>> pending;
 
-seq::Generic seq::Executor::executeExpr( seq::Generic entity ) {
+	const unsigned int entry = this->operations.size();
+	this->functions.emplace( key, entry );
 
-	// get entity properties
-	seq::DataType type = entity.getDataType();
-	bool anchor = entity.getAnchor();
+	seq::Stream& body = this->decode( reader );
 
-	// if given entity is an expression pass it to executeExprPair
-	if( type == seq::DataType::Expr ) {
-		auto& expr = entity.Expression();
+	// load the first argument
+	this->operations.push_back( { nullptr, entry + 1, 0, seq::Operation::Code::Next } );
 
-		seq::Generic left = expr.getLeftReader().next().getGeneric();
-		seq::Generic right = expr.getRightReader().next().getGeneric();
-		seq::ExprOperator op = expr.getOperator();
+	for( seq::Generic& command : body ) {
 
-		return this->executeExprPair( std::move(left), std::move(right), op, anchor );
-	}
+		// functions can only contain streams
+		if( command.getDataType() != seq::DataType::Stream ) {
+			throw seq::InternalError( "Invalid command in function!" );
+		}
 
-	// if it is simple argument resolve it's value
-	if( type == seq::DataType::Arg ) {
-		auto& arg = entity.Arg();
+		const unsigned int match = this->operations.size();
+		this->operations.push_back( { &command, 0, 0, seq::Operation::Code::Match } );
+		this->lowerStream( this->decode( command.Stream().getReader() ), 0, pending );
+		this->operations.push_back( { nullptr, 0, 0, seq::Operation::Code::Done } );
+		this->operations[match].target = this->operations.size();
 
-		// get stack level to which the argument is referring
-		long s = (long) this->stack.size() - 1L - (long) arg.getLevel();
+	}
 
-		// according to Sequensa specification
-		// if argument reference is invalid null should be returned instead
-		if( s < 0 ) {
-			return seq::util::newNull( anchor );
-		}
+	// load the next argument and start over
+	this->operations.push_back( { nullptr, entry + 1, 0, seq::Operation::Code::Next } );
 
-		// return stack argument
-		auto ret = this->stack[s].getArg();
-		ret.setAnchor(anchor);
-		return ret;
+	for( auto& call : pending ) {
+		const unsigned int target = this->lowerFunction( call.second );
+		this->operations[call.first].target = target;
 	}
 
-	// else: return unchanged
-	return entity;
+	return entry;
 
 }
 
-seq::Stream seq::Executor::resolveName( std::string& name, bool anchor ) {
+void seq::Executor::lowerStream( seq::Stream& stream, unsigned int reg, std::vector<std::pair<unsigned int, seq::BufferReader>>& pending ) {
 
-	// iterate stack levels in search of the specified variable
-	for( int i = (int) this->stack.size() - 1; i >= 0; i -- ) {
+	// streams are evaluated from right to left, embedded streams use the next register
+	for( long i = (long) stream.size() - 1; i >= 0; i -- ) {
 
-		try{
-			return this->stack.at(i).getVar( name, anchor );
-		} catch (std::out_of_range &err) {
+		seq::Generic& entity = stream[i];
+		const seq::Operation::Code code = seq::Operation::classify( entity );
+
+		if( code == seq::Operation::Code::Open ) {
+			this->operations.push_back( { nullptr, 0, reg + 1, code } );
+			this->lowerStream( this->decode( entity.Stream().getReader() ), reg + 1, pending );
+			this->operations.push_back( { nullptr, 0, reg + 1, seq::Operation::Code::Merge } );
 			continue;
 		}
 
-	}
+		// function literals are lowered with the rest of the program
+		if( entity.getDataType() == seq::DataType::Func ) {
+			pending.emplace_back( this->operations.size(), entity.Function().getReader() );
+		}
 
-	// if executor has a parent, ask him
-	if( parent != nullptr ) {
-		return parent->resolveName( name, anchor );
-	}
+		this->operations.push_back( { &entity, SEQ_NO_ENTRY, reg, code } );
 
-	// if symbol wasn't found throw runtime exception
-	throw seq::RuntimeError( "Referenced undefined symbol: '" + name + "'" );
+	}
 
 }
 
-void seq::Executor::defineName( std::string& name, Stream& value, bool define ) {
+seq::Stream seq::Executor::executeFlowc( seq::type::Flowc& flowc, seq::Stream& input_stream ) {
 
-	// iterate stack levels in search of the specified variable
-	for( int i = (int) this->stack.size() - 1; i >= 0; i -- ) {
+	seq::Stream acc;
 
-		try{
+#	ifdef SEQ_JIT_NATIVE
+	if( this->jitEnabled && this->executeNativeFlowc( flowc.getConditions(), input_stream, acc ) ) {
+		return acc;
+	}
+#	endif
 
-			auto& level = this->stack.at(i);
+	const seq::FlowMatcher& matcher = flowc.getMatcher();
 
-			// when it's found modify current value
-			if( level.hasVar( name ) ) {
-				level.setVar( name, value );
-				return;
-			}
+	// streams of numbers are checked all at once
+	if( input_stream.size() >= SEQ_BATCH_MIN ) {
+		std::vector<double> values;
 
-		} catch (std::out_of_range &err) {
-			continue;
-		}
+		if( seq::util::packNumbers( input_stream, values ) ) {
+			std::vector<byte> mask( values.size() );
+			matcher.validate( values.data(), mask.data(), values.size() );
 
-	}
+			for( size_t i = 0; i < values.size(); i ++ ) {
+				if( mask[i] ) acc.push_back( input_stream[i] );
+			}
 
-	// if executor has a parent, ask him
-	if( parent != nullptr ) {
-		return parent->defineName( name, value, false );
+			return acc;
+		}
 	}
 
-	// if symbol wasn't found create new variable in top stack level
-	if( define ) {
-		getTopLevel()->setVar(name, value);
+	// check if arg satisfies flowc conditions
+	for( seq::Generic& arg : input_stream ) {
+		if( matcher.validate( arg ) ) {
+			acc.push_back( arg );
+		}
 	}
 
+	// return matching entities
+	return acc;
 }
 
-seq::type::Native seq::Executor::resolveNative( std::string& name ) {
+#ifdef SEQ_JIT_NATIVE
 
-	try{
+bool seq::Executor::executeNative( seq::type::Expression& expr, bool anchor, seq::Generic& result ) {
 
-		return this->natives.at( name );
+	// expressions are keyed by their address in the bytecode, like decoded bodies
+	seq::JitCompiler::Entry& entry = this->nativeExprs[ expr.getLeftReader().bytes() ];
 
-	}catch(std::out_of_range &err) {
+	// compile once the expression gets hot, unsupported expressions are not retried
+	if( entry.code == nullptr ) {
+		if( entry.hits ++ != SEQ_JIT_THRESHOLD || !this->jit.compileExpression( expr, entry ) ) {
+			return false;
+		}
+	}
 
-		if( parent != nullptr ) {
+	double args[8];
 
-			return parent->resolveNative( name );
+	for( size_t i = 0; i < entry.levels.size(); i ++ ) {
+		long s = (long) this->stack.size() - 1L - (long) entry.levels[i];
 
+		// leave invalid and non-numeric arguments to the interpreter
+		if( s < 0 ) {
+			return false;
 		}
 
-		throw err;
+		seq::Generic arg = this->stack[s].getArg();
+		if( arg.getDataType() != seq::DataType::Number ) {
+			return false;
+		}
 
+		// the compiled code is only exact for limited arguments
+		args[i] = arg.Number().getDouble();
+		if( std::abs( args[i] ) > SEQ_JIT_LIMIT ) {
+			return false;
+		}
 	}
 
+	const double value = ((seq::JitCompiler::ExprFunc) entry.code)( args );
+	result = entry.boolean ? seq::util::newBool( value != 0, anchor ) : seq::util::newNumber( value, anchor );
+	return true;
 }
 
-std::unordered_map<std::string, seq::type::Native>& seq::Executor::getNativesMap() {
+bool seq::Executor::executeNativeFlowc( const std::vector<seq::FlowCondition*>& fcs, seq::Stream& input_stream, seq::Stream& acc ) {
 
-	return this->natives;
+	// only numeric value and range conditions can be compiled
+	for( seq::FlowCondition* fc : fcs ) {
+		if( fc->type == seq::FlowCondition::Type::Type || fc->a.getDataType() != seq::DataType::Number ) return false;
+		if( fc->type == seq::FlowCondition::Type::Range && fc->b.getDataType() != seq::DataType::Number ) return false;
+	}
 
-}
+	if( fcs.empty() ) {
+		return false;
+	}
 
-seq::Stream seq::Executor::executeFlowc( std::vector<seq::FlowCondition*> fcs, seq::Stream& input_stream ) {
+	// conditions are copied along with flowcs, so they are keyed by the address
+	// of the first one and verified against the values used to compile the entry
+	seq::JitCompiler::Entry& entry = this->nativeFlowcs[ fcs[0] ];
+	bool valid = entry.constants.size() == fcs.size() * 3;
 
-	seq::Stream acc;
+	for( size_t i = 0; valid && i < fcs.size(); i ++ ) {
+		const double values[3] = { (double) fcs[i]->type, fcs[i]->a.Number().getDouble(), fcs[i]->type == seq::FlowCondition::Type::Range ? fcs[i]->b.Number().getDouble() : 0 };
+		valid = memcmp( values, entry.constants.data() + i * 3, sizeof( values ) ) == 0;
+	}
 
-	for( seq::Generic& arg : input_stream ) {
+	if( !valid ) {
+		entry = seq::JitCompiler::Entry();
 
-		// check if arg satisfies flowc conditions
 		for( seq::FlowCondition* fc : fcs ) {
-			if( fc->validate( arg ) ) {
-				acc.push_back( arg );
-				break;
-			}
+			entry.constants.push_back( (double) fc->type );
+			entry.constants.push_back( fc->a.Number().getDouble() );
+			entry.constants.push_back( fc->type == seq::FlowCondition::Type::Range ? fc->b.Number().getDouble() : 0 );
+		}
+	}
+
+	if( entry.code == nullptr ) {
+		if( entry.hits ++ != SEQ_JIT_THRESHOLD || !this->jit.compileFlowc( fcs, entry ) ) {
+			return false;
 		}
+	}
+
+	auto fn = (seq::JitCompiler::FlowcFunc) entry.code;
 
+	// numeric conditions can't match any other types
+	for( seq::Generic& arg : input_stream ) {
+		if( arg.getDataType() == seq::DataType::Number && fn( arg.Number().getDouble() ) ) {
+			acc.push_back( arg );
+		}
 	}
 
-	// return matching entities
-	return acc;
+	return true;
 }
 
+seq::JitCompiler& seq::Executor::getJit() {
+	return this->jit;
+}
+
+#endif
+
 seq::Generic seq::Executor::executeCast( seq::Generic cast, seq::Generic arg ) {
 
 	switch( cast.getDataType() ) {
@@ -3199,7 +7078,7 @@ seq::Generic seq::Executor::executeCast( seq::Generic cast, seq::Generic arg ) {
 			switch( cast.Type().getType() ) {
 
 				case seq::DataType::Type:
-					return seq::Generic( new seq::type::Type( false, arg.getDataType() ) );
+					return seq::util::newType( arg.getDataType() );
 
 				case seq::DataType::Bool:
 					return seq::util::boolCast( arg );
@@ -3759,6 +7638,40 @@ int seq::Compiler::findClosing( std::vector<seq::Compiler::Token>& tokens, int i
 	return index;
 }
 
+bool seq::Compiler::isTailCall( std::vector<seq::Compiler::Token>& tokens, int start, int end ) {
+
+	// expected: (#return|#final) << (#name|#{...}) << ...
+	if( end - start < 4 ) {
+		return false;
+	}
+
+	auto& call = tokens[start];
+	if( call.getCategory() != seq::Compiler::Token::Category::VMCall ) return false;
+	if( call.getData() != (long) seq::type::VMCall::CallType::Return && call.getData() != (long) seq::type::VMCall::CallType::Final ) return false;
+	if( tokens[start + 1].getCategory() != seq::Compiler::Token::Category::Stream ) return false;
+
+	auto& callee = tokens[start + 2];
+	int next = start + 3;
+
+	if( !callee.getAnchor() ) {
+		return false;
+	}
+
+	if( callee.getCategory() == seq::Compiler::Token::Category::FuncBracket ) {
+
+		// skip the function body
+		for( int depth = 1; depth != 0; next ++ ) {
+			if( next > end ) return false;
+			if( tokens[next].getCategory() == seq::Compiler::Token::Category::FuncBracket ) depth += tokens[next].getData();
+		}
+
+	}else if( callee.getCategory() != seq::Compiler::Token::Category::Name ) {
+		return false;
+	}
+
+	return next < end && tokens[next].getCategory() == seq::Compiler::Token::Category::Stream;
+}
+
 std::vector<byte> seq::Compiler::assembleStream( std::vector<seq::Compiler::Token>& tokens, int start, int end, byte tags, bool embedded ) {
 
 	enum struct State: byte {
@@ -3804,7 +7717,7 @@ std::vector<byte> seq::Compiler::assembleStream( std::vector<seq::Compiler::Toke
 
 			case State::Continue:
 				if( token.getCategory() == seq::Compiler::Token::Category::Name ) {
-					bw.putName( token.getAnchor(), false, token.getClean().c_str() );
+					bw.putName( token.getAnchor(), false, token.getClean().c_str(), getSlot( token.getClean() ) );
 					state = State::Stream;
 					break;
 				}
@@ -3850,7 +7763,7 @@ std::vector<byte> seq::Compiler::assembleStream( std::vector<seq::Compiler::Toke
 			case State::Set:
 				if( token.getCategory() == seq::Compiler::Token::Category::Name ) {
 					if( !token.getAnchor() ) {
-						bw.putName( token.getAnchor(), true, token.getClean().c_str() );
+						bw.putName( token.getAnchor(), true, token.getClean().c_str(), getSlot( token.getClean() ) );
 						state = State::Stream;
 						break;
 					}else{
@@ -3959,7 +7872,7 @@ std::vector<byte> seq::Compiler::assemblePrimitive( seq::Compiler::Token token )
 
 			// Name is not a primitive value but this simplifies some things
 			case seq::Compiler::Token::Category::Name:
-				bw.putName( token.getAnchor(), false, token.getClean().c_str() );
+				bw.putName( token.getAnchor(), false, token.getClean().c_str(), getSlot( token.getClean() ) );
 				break;
 
 			default:
@@ -4216,6 +8129,11 @@ std::vector<byte> seq::Compiler::assembleFunction( std::vector<seq::Compiler::To
 		int j = findStreamEnd( tokens, i, end );
 		if( j != -1 ) {
 
+			// mark the last stream if it ends the function with a call
+			if( ( flags & (oflag_t) Optimizations::TailCall ) && j + 1 >= end && isTailCall( tokens, i, j ) ) {
+				tags |= SEQ_TAG_TAIL;
+			}
+
 			auto buf = assembleStream( tokens, i, j, tags, false );
 			bw.putBuffer(buf);
 			i = j;
@@ -4337,6 +8255,17 @@ seq::StringTable* seq::Compiler::getTable() {
 	return ( flags & (seq::oflag_t) Optimizations::Name ) ? names : nullptr;
 }
 
+unsigned int seq::Compiler::getSlot( const std::string& name ) {
+
+	// namespaced names (like 'std:pi') are defined by natives at runtime
+	if( !( flags & (seq::oflag_t) Optimizations::Slots ) || name.find( ':' ) != std::string::npos ) {
+		return SEQ_NO_SLOT;
+	}
+
+	// slots are numbered in order of first use and shared by all programs of this compiler
+	return slots.emplace( name, (unsigned int) slots.size() ).first->second;
+}
+
 void seq::Compiler::emit( seq::CompilerError error ) {
 	if( this->handle( &error ) || error.isCritical() ) {
 		throw error;
@@ -4469,7 +8398,8 @@ std::string seq::SourceDecompiler::writeNumber( Generic& g ) {
 
 std::string seq::SourceDecompiler::writeFunc( Generic& g ) {
 	indentation.push();
-	std::string str = anchor(g) + "{\n" + decompile( g.Function().getReader() );
+	seq::BufferReader br = g.Function().getReader();
+	std::string str = anchor(g) + "{\n" + decompile( br );
 	indentation.pop();
 	return str + indentation.get() + "} ";
 }
@@ -4490,7 +8420,9 @@ std::string seq::SourceDecompiler::writeFlowc( Generic& g ) {
 
 std::string seq::SourceDecompiler::writeExpr( Generic& g ) {
 	type::Expression& e = g.Expression();
-	return "( " + decompile( e.getLeftReader() ) + exprop(e.getOperator()) + " " + decompile(e.getRightReader()) + ") ";
+	seq::BufferReader lbr = e.getLeftReader();
+	seq::BufferReader rbr = e.getRightReader();
+	return "( " + decompile( lbr ) + exprop(e.getOperator()) + " " + decompile( rbr ) + ") ";
 }
 
 std::string seq::SourceDecompiler::writeName( Generic& g ) {
@@ -4516,7 +8448,8 @@ std::string seq::SourceDecompiler::writeString( Generic& g ) {
 }
 
 std::string seq::SourceDecompiler::writeStream( Generic& g ) {
-	seq::Stream stream = g.Stream().getReader().readAll();
+	seq::BufferReader br = g.Stream().getReader();
+	seq::Stream stream = br.readAll();
 	int size = stream.size();
 	byte tags = g.Stream().getTags();
 
@@ -175,6 +175,11 @@ FUNC void seq_executor_strict_math( void* executor, bool flag ) {
 	((seq::Executor*) executor)->setStrictMath(flag);
 }
 
+/// Set Executor's engine (1 - tree, 2 - threaded, 3 - register)
+FUNC void seq_executor_engine( void* executor, seq::byte engine ) {
+	((seq::Executor*) executor)->setEngine( (seq::Engine) engine );
+}
+
 /// Execute given program
 FUNC void seq_executor_execute( void* executor, void* buffer, int size, ErrorHandle func ) {
 	try{
@@ -215,6 +220,12 @@ FUNC void* seq_stream_generic_ptr( void* stream, int index ) {
 	return (void*) (*((seq::Stream*) stream))[index].getRaw();
 }
 
+/// Get anchor of generic from stream, unlike seq_generic_anchor
+/// this also works for shared values whose anchor was changed
+FUNC int seq_stream_generic_anchor( void* stream, int index ) {
+	return (int) (*((seq::Stream*) stream))[index].getAnchor();
+}
+
 /// Clear the stream
 FUNC void seq_stream_clear( void* stream ) {
 	((seq::Stream*) stream)->clear();
@@ -230,7 +241,7 @@ FUNC int seq_generic_type( void* generic ) {
 	return (int) ((seq::type::Generic*) generic)->getDataType();
 }
 
-/// Get anchor from generic
+/// Get anchor from generic, for values taken from a stream use seq_stream_generic_anchor
 FUNC int seq_generic_anchor( void* generic ) {
 	return (int) ((seq::type::Generic*) generic)->getAnchor();
 }
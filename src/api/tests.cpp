@@ -27,12 +27,43 @@
 #include "dyncapi.cpp"
 #include "../lib/vstl.hpp"
 
+#include <chrono>
+
 // Test coverage: 91.89%
 // Last updated: 2020-11-26
 // Warning: This information may be out of date!
 
 using seq::byte;
 
+// counts heap allocations, used by the allocation benchmarks
+long allocation_count = 0;
+
+void* operator new( std::size_t size ) {
+	allocation_count ++;
+	void* ptr = std::malloc( size ? size : 1 );
+	if( ptr == nullptr ) throw std::bad_alloc();
+	return ptr;
+}
+
+void operator delete( void* ptr ) noexcept {
+	std::free( ptr );
+}
+
+// returns the number of heap allocations made while executing the given program,
+// the program is compiled and executed once before counting to warm up the executor
+long count_allocations( const std::string& code, seq::Engine engine = seq::Engine::Tree ) {
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	seq::Executor exe;
+	exe.setEngine( engine );
+	exe.execute( bb );
+
+	long start = allocation_count;
+	exe.execute( bb );
+	return allocation_count - start;
+}
+
 // used for debugging
 void print_buffer( seq::ByteBuffer& bb ) {
 	seq::StringTable* table = bb.getStringTable();
@@ -153,7 +184,7 @@ TEST( buffer_writer_complex, {
 		seq::TokenReader tr = br.next();
 		CHECK( (byte) tr.getDataType(), (byte) seq::DataType::Number );
 		CHECK( tr.isAnchored(), false );
-		CHECK( tr.getGeneric().Number().getLong(), (long) 12 );
+		CHECK( tr.getGeneric().Number().getLong(), (int64_t) 12 );
 	}
 
 	{ // fraction
@@ -167,21 +198,21 @@ TEST( buffer_writer_complex, {
 		seq::TokenReader tr = br.next();
 		CHECK( (byte) tr.getDataType(), (byte) seq::DataType::Number );
 		CHECK( tr.isAnchored(), false );
-		CHECK( tr.getGeneric().Number().getLong(), (long) 1422131241 );
+		CHECK( tr.getGeneric().Number().getLong(), (int64_t) 1422131241 );
 	}
 
 	{ // 2 byte aligned number
 		seq::TokenReader tr = br.next();
 		CHECK( (byte) tr.getDataType(), (byte) seq::DataType::Number );
 		CHECK( tr.isAnchored(), false );
-		CHECK( tr.getGeneric().Number().getLong(), (long) 0b1000010101010001l );
+		CHECK( tr.getGeneric().Number().getLong(), (int64_t) 0b1000010101010001l );
 	}
 
 	{ // 2 byte aligned negative number
 		seq::TokenReader tr = br.next();
 		CHECK( (byte) tr.getDataType(), (byte) seq::DataType::Number );
 		CHECK( tr.isAnchored(), false );
-		CHECK( tr.getGeneric().Number().getLong(), (long) -0b1000010101010001l );
+		CHECK( tr.getGeneric().Number().getLong(), (int64_t) -0b1000010101010001l );
 	}
 
 	{ // string
@@ -230,7 +261,7 @@ TEST( buffer_writer_complex, {
 		seq::TokenReader tr = br.next();
 		CHECK( (byte) tr.getDataType(), (byte) seq::DataType::Number );
 		CHECK( tr.isAnchored(), true );
-		CHECK( tr.getGeneric().Number().getLong(), (long) 0 );
+		CHECK( tr.getGeneric().Number().getLong(), (int64_t) 0 );
 	}
 
 } );
@@ -366,8 +397,8 @@ TEST( buffer_writer_flowc, {
 
 		CHECK( fcs.size(), (size_t) 2 );
 		CHECK( (byte) fcs.at(0)->type, (byte) seq::FlowCondition::Type::Range );
-		CHECK( fcs.at(0)->a.Number().getLong(), (long) 12);
-		CHECK( fcs.at(0)->b.Number().getLong(), (long) 24);
+		CHECK( fcs.at(0)->a.Number().getLong(), (int64_t) 12);
+		CHECK( fcs.at(0)->b.Number().getLong(), (int64_t) 24);
 		CHECK( (byte) fcs.at(1)->type, (byte) seq::FlowCondition::Type::Value );
 		CHECK( fcs.at(1)->a.Bool().getBool(), false );
 	}
@@ -641,7 +672,7 @@ TEST( executor_native, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), (long) 10 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 10 );
 
 } );
 
@@ -672,7 +703,7 @@ TEST( expression_simple, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), (long) 42 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 42 );
 
 } );
 
@@ -757,7 +788,7 @@ TEST( ce_expression, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), (long) 10 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 10 );
 
 } );
 
@@ -775,7 +806,7 @@ TEST( ce_expression_nested_right, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), (long) 6 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 6 );
 
 } );
 
@@ -792,7 +823,7 @@ TEST( ce_expression_nested_left, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), (long) 6 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 6 );
 
 } );
 
@@ -810,7 +841,7 @@ TEST( ce_expression_nested_double, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), (long) 10 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 10 );
 
 } );
 
@@ -827,7 +858,7 @@ TEST( ce_expression_float, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 555l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 555 );
 
 } );
 
@@ -849,7 +880,7 @@ TEST( ce_expression_complex, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 10l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 10 );
 
 } );
 
@@ -870,7 +901,7 @@ TEST( ce_arg, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 30l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 30 );
 
 } );
 
@@ -943,7 +974,7 @@ TEST( ce_flowc_3, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 2l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 2 );
 
 } );
 
@@ -960,7 +991,7 @@ TEST( ce_flowc_4, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 2l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 2 );
 
 } );
 
@@ -1030,13 +1061,13 @@ TEST( ce_type_cast_number_1, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 123l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 123 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
 	CHECK( res.at(1).Number().getDouble(), 42.5 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 1l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 1 );
 
 } );
 
@@ -1055,13 +1086,13 @@ TEST( ce_type_cast_number_2, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 6l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 6 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 0l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 0 );
 
 } );
 
@@ -1171,7 +1202,7 @@ TEST( ce_complex_sum, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 10l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 10 );
 
 } );
 
@@ -1193,7 +1224,7 @@ TEST( ce_header, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 1l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 1 );
 	CHECK( (long) loades.size(), 2l );
 
 	CHECK_ELSE( loades.at(0), std::string( "test-1" ) ) {
@@ -1232,6 +1263,105 @@ TEST( ce_simple_loop, {
 } );
 
 
+TEST( ce_again_tags, {
+
+	std::string code = R"(
+		#exit << #{
+			first; #return << 100
+			#return << #@ << #[true] << (@ > 0)
+			#again << #{
+				#return << (@ - 1) << (@ - 2)
+			} << #@ << #[true] << (@ > 1)
+			last; #return << 200
+			end; #return << 300
+		} << 3 << 1 << 5
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	seq::Executor exe;
+	exe.execute( bb );
+
+	// reinserted arguments keep their order and restart the 'first' tag
+	const int64_t expected[] = { 100, 3, 100, 2, 100, 1, 1, 1, 5, 200, 100, 4, 100, 3, 100, 2, 100, 1, 1, 2, 100, 1, 3, 200, 100, 2, 100, 1, 1, 200, 300 };
+	auto& res = exe.getResults();
+
+	CHECK( res.size(), sizeof( expected ) / sizeof( int64_t ) );
+
+	for( size_t i = 0; i < res.size(); i ++ ) {
+		CHECK( res[i].Number().getLong(), expected[i] );
+	}
+
+} );
+
+
+TEST( ce_function_input, {
+
+	auto buf = seq::Compiler::compileStatic( "#again << #(@ - 1) << #[true] << (@ > 2)\n#return << (@ * 10)" );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	const seq::Engine engines[] = { seq::Engine::Tree, seq::Engine::Threaded, seq::Engine::Register };
+
+	for( seq::Engine engine : engines ) {
+		seq::Executor exe;
+		exe.setEngine( engine );
+
+		// the stream given to executeFunction is left unchanged
+		seq::Stream input = { seq::util::newNumber( 1 ), seq::util::newNumber( 4 ), seq::util::newNumber( 2 ) };
+		seq::CommandResult cr = exe.executeFunction( bb.getReader(), input, false );
+
+		std::string str;
+		for( auto& g : input ) str += seq::util::stringCast( g ).String().getString() + " ";
+		str += "|";
+		for( auto& g : cr.acc ) str += " " + seq::util::stringCast( g ).String().getString();
+
+		CHECK_ELSE( str, std::string( "1 4 2 | 10 40 30 20 20" ) ) {
+			FAIL( "Invalid result: " + str );
+		}
+	}
+
+} );
+
+TEST( ce_tags_partition, {
+
+	// tagged streams interleaved in any order, single argument calls (tagged both
+	// first and last), and a tail call that switches to a body with the end tag
+	std::string code = R"(
+		set f << {
+			end; #return << "e"
+			first; #return << "f"
+			#return << @
+			last; #return << "l"
+			first; #return << "g"
+		}
+		set g << {
+			first; #return << "s"
+			#return << #f << @
+		}
+		#exit << #f << 1 << 2 << #g << 3 << 4
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	const seq::Engine engines[] = { seq::Engine::Tree, seq::Engine::Threaded, seq::Engine::Register };
+
+	for( seq::Engine engine : engines ) {
+		seq::Executor exe;
+		exe.setEngine( engine );
+		exe.execute( bb );
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+		CHECK_ELSE( str, std::string( "f 1 g 2 s f 3 l g e f 4 l g e l e " ) ) {
+			FAIL( "Invalid result: " + str );
+		}
+	}
+
+} );
+
 TEST( ce_fibonacci_recursion, {
 
 	std::string code = R"(
@@ -1260,16 +1390,16 @@ TEST( ce_fibonacci_recursion, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 34l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 34 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 89l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 89 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 8l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 8 );
 
 	CHECK( (byte) res.at(3).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(3).Number().getLong(), 144l );
+	CHECK( res.at(3).Number().getLong(), (int64_t) 144 );
 
 } );
 
@@ -1341,16 +1471,16 @@ TEST( ce_factorial_recursion, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 120l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 120 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 5040l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 5040 );
 
 	CHECK( (byte) res.at(3).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(3).Number().getLong(), 6l );
+	CHECK( res.at(3).Number().getLong(), (int64_t) 6 );
 
 } );
 
@@ -1370,13 +1500,13 @@ TEST( ce_order_1, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 2l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 2 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 3l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 3 );
 
 } );
 
@@ -1395,13 +1525,13 @@ TEST( ce_order_2, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 2l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 2 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 3l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 3 );
 
 } );
 
@@ -1421,13 +1551,13 @@ TEST( ce_order_3, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 2l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 2 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 3l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 3 );
 
 } );
 
@@ -1446,13 +1576,13 @@ TEST( ce_order_4, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 2l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 2 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 3l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 3 );
 
 } );
 
@@ -1472,13 +1602,13 @@ TEST( ce_order_5, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 2l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 2 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 3l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 3 );
 
 } );
 
@@ -1497,7 +1627,7 @@ TEST( ce_expr_complex_math, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 575l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 575 );
 
 } );
 
@@ -1533,7 +1663,7 @@ TEST( ce_deep_function, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 10l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 10 );
 
 } );
 
@@ -1554,7 +1684,7 @@ TEST( ce_top_args, {
 	exe.execute( bb, args );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 2l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 2 );
 
 } );
 
@@ -1572,7 +1702,7 @@ TEST( ce_namespace, {
 	exe.execute( bb );
 
 	CHECK( (byte) exe.getResult().getDataType(), (byte) seq::DataType::Number );
-	CHECK( exe.getResult().Number().getLong(), 123l );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 123 );
 
 } );
 
@@ -1635,10 +1765,10 @@ TEST( ce_blob, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 123l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 123 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 456l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 456 );
 
 } )
 
@@ -1658,13 +1788,13 @@ TEST( ce_accessor_operator, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 123l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 123 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 456l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 456 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 789l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 789 );
 
 	CHECK( (byte) res.at(3).getDataType(), (byte) seq::DataType::Null );
 
@@ -1737,7 +1867,7 @@ TEST( ce_value_cast, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
 	CHECK( res.at(1).Number().getDouble(), 0.5 );
@@ -1793,10 +1923,10 @@ TEST( ce_simple_define, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 12l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 12 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 33l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 33 );
 
 } );
 
@@ -1836,19 +1966,19 @@ TEST( ce_composite_order, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 0l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 0 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 1l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 2l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 2 );
 
 	CHECK( (byte) res.at(3).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(3).Number().getLong(), 3l );
+	CHECK( res.at(3).Number().getLong(), (int64_t) 3 );
 
 	CHECK( (byte) res.at(4).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(4).Number().getLong(), 4l );
+	CHECK( res.at(4).Number().getLong(), (int64_t) 4 );
 
 } );
 
@@ -1867,10 +1997,10 @@ TEST( ce_flowc_cast, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 5l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 5 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 8l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 8 );
 
 } );
 
@@ -1890,16 +2020,16 @@ TEST( ce_accessor_complex, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 10l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 10 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 14l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 14 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 13l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 13 );
 
 	CHECK( (byte) res.at(3).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(3).Number().getLong(), 10l );
+	CHECK( res.at(3).Number().getLong(), (int64_t) 10 );
 
 } );
 
@@ -1920,7 +2050,7 @@ TEST( ce_accessor_cast, {
 
 	CHECK( (long) res.size(), 1l );
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 7l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 7 );
 
 } );
 
@@ -1939,13 +2069,13 @@ TEST( ce_embedded_streams, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 3l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 3 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 4l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 4 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 5l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 5 );
 
 } );
 
@@ -1986,7 +2116,7 @@ TEST( ce_nested_stream_native, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 } );
 
@@ -2008,7 +2138,7 @@ TEST( ce_set_empty, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 42l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 42 );
 
 } );
 
@@ -2045,10 +2175,10 @@ TEST( ce_negative_numbers, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), -1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) -1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), -2l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) -2 );
 
 } );
 
@@ -2106,10 +2236,10 @@ TEST( ce_between_anchors, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 1l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 1 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 2l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 2 );
 
 } );
 
@@ -2128,7 +2258,7 @@ TEST( ce_casts, {
 	auto& res = exe.getResults();
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 0l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 0 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::String );
 	CHECK_ELSE( res.at(1).String().getString(), std::string( "false" ) ) {
@@ -2237,13 +2367,13 @@ TEST( ce_flowc_range, {
 	CHECK( (int) res.size(), (int) 3 )
 
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), 2l );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 2 );
 
 	CHECK( (byte) res.at(1).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(1).Number().getLong(), 3l );
+	CHECK( res.at(1).Number().getLong(), (int64_t) 3 );
 
 	CHECK( (byte) res.at(2).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(2).Number().getLong(), 4l );
+	CHECK( res.at(2).Number().getLong(), (int64_t) 4 );
 
 } );
 
@@ -2277,7 +2407,7 @@ TEST( ce_binary_op, {
 
 	CHECK( (int) res.size(), (int) 1 )
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), (long) (((6 & 2) | 1) ^ 7) );
+	CHECK( res.at(0).Number().getLong(), (int64_t) (((6 & 2) | 1) ^ 7) );
 
 } );
 
@@ -2403,7 +2533,7 @@ TEST( ce_long_namespace, {
 
 	CHECK( (int) res.size(), (int) 1 )
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), (long) 123 );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 123 );
 
 } );
 
@@ -2548,7 +2678,50 @@ TEST( ce_executor_parenting, {
 
 	CHECK( (int) res.size(), (int) 1 );
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), (long) (42 + 13 + 37 + 1) );
+	CHECK( res.at(0).Number().getLong(), (int64_t) (42 + 13 + 37 + 1) );
+
+} );
+
+TEST( ce_nested_buffers, {
+
+	std::string code = R"SEQ(
+		#exit << #run << "#exit << 1" << "#exit << 2" << "#exit << 3"
+	)SEQ";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	static seq::Executor exe;
+
+	// every program is compiled into a new buffer that is freed right after being
+	// executed, so the buffers are likely to share an address
+	exe.inject( "run", [] (seq::Stream* stream) -> seq::Stream* {
+		seq::Stream* output = new seq::Stream();
+
+		for( auto& arg : *stream ) {
+			auto buf = seq::Compiler::compileStatic( arg.String().getString() );
+			seq::ByteBuffer bb( buf.data(), buf.size() );
+
+			exe.execute( bb );
+			output->insert( output->end(), exe.getResults().begin(), exe.getResults().end() );
+		}
+
+		return output;
+	} );
+
+	const seq::Engine engines[] = { seq::Engine::Tree, seq::Engine::Threaded, seq::Engine::Register };
+
+	for( seq::Engine engine : engines ) {
+		exe.setEngine( engine );
+		exe.execute( bb );
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+		CHECK_ELSE( str, std::string( "1 2 3 " ) ) {
+			FAIL( "Invalid result: " + str );
+		}
+	}
 
 } );
 
@@ -2607,7 +2780,7 @@ TEST( co_names_table, {
 
 	CHECK( (int) res.size(), (int) 1 );
 	CHECK( (byte) res.at(0).getDataType(), (byte) seq::DataType::Number );
-	CHECK( res.at(0).Number().getLong(), (long) 3*3*3*3*3*3 );
+	CHECK( res.at(0).Number().getLong(), (int64_t) 3*3*3*3*3*3 );
 
 	if( table.size() < 2 ) {
 		FAIL( "Name table failed to generate!" );
@@ -2842,6 +3015,21 @@ TEST( capi_basic, {
 
 } );
 
+TEST( capi_anchors, {
+
+	// both copies share one payload, only the second one is anchored
+	seq::Stream stream;
+	seq::Generic value( new seq::type::String( false, "text" ) );
+	seq::Generic copy = value;
+	copy.setAnchor( true );
+	stream.push_back( value );
+	stream.push_back( copy );
+
+	if( seq_stream_generic_anchor( &stream, 0 ) ) FAIL( "Expected no anchor!" );
+	if( !seq_stream_generic_anchor( &stream, 1 ) ) FAIL( "Expected anchor!" );
+
+} );
+
 TEST( capi_natives, {
 
 	// create objects
@@ -2913,6 +3101,1107 @@ TEST( bwr_header_version, {
 
 } );
 
+TEST( ce_decode_cache, {
+
+	std::string code = R"(
+		set sum << {
+			first; set x << 0
+			set x << (x :: 0 + @)
+			end; #return << x
+		}
+
+		#exit << #sum << #{
+			#return << (@ * 2) << (@ + 1)
+		} << 1 << 2 << 3 << 4 << 5
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	seq::Executor exe;
+	exe.execute( bb );
+
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 50 );
+
+	// decoded bodies are reused, not decoded again
+	seq::BufferReader br = bb.getReader();
+	seq::Stream& a = exe.decode( br );
+	seq::Stream& b = exe.decode( br );
+
+	CHECK( (long) &a, (long) &b );
+	CHECK( br.size(), (int) buf.size() );
+
+	// and executing the program again yields the same result
+	exe.execute( bb );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 50 );
+
+} );
+
+TEST( ce_slot_names, {
+
+	std::string code = R"(
+		set x << 1
+		set f << {
+			set x << (x :: 0 + @)
+			#return << x << y
+		}
+
+		#{
+			set y << 10
+			#{
+				set y << 20
+				#return << #f << @
+			} << @
+			#return << y << var
+		} << 1 << 2
+
+		#exit << x << y << var << #{
+			set x << 100
+			#return << x
+		} << null
+	)";
+
+	auto run = [] ( std::vector<byte>& buf ) -> std::string {
+		seq::ByteBuffer bb( buf.data(), buf.size() );
+		seq::Executor exe;
+		exe.define( "var", { seq::util::newNumber( 5 ) } );
+		exe.define( "y", { seq::util::newNumber( 0 ) } );
+		exe.execute( bb );
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+		return str;
+	};
+
+	auto plain = seq::Compiler::compileStatic( code );
+	auto slots = seq::Compiler::compileStatic( code, nullptr, (seq::oflag_t) seq::Optimizations::Slots );
+
+	// names are compiled to slot opcodes
+	seq::ByteBuffer bb( slots.data(), slots.size() );
+	seq::BufferReader br = bb.getReader();
+	seq::BufferReader sbr = br.next().getGeneric().Stream().getReader();
+	seq::Stream stream = sbr.readAll();
+
+	CHECK( stream.front().Name().getDefine(), true );
+	CHECK( stream.front().Name().getSlot(), 0u );
+
+	CHECK_ELSE( run( slots ), run( plain ) ) {
+		FAIL( "Slot addressed names don't match map addressed names!" );
+	}
+
+	CHECK_ELSE( run( slots ), std::string( "100 20 5 100 " ) ) {
+		FAIL( "Invalid result: " + run( slots ) );
+	}
+
+} );
+
+TEST( ce_engines, {
+
+	std::vector<std::string> programs = {
+		R"(
+			set factorial << {
+				#return << #{
+					#final << #1 << #[true] << (@ <= 0)
+					#return << #{
+						#final << (@@ * @)
+					} << #factorial << (@ - 1)
+				} << @
+			}
+
+			#exit << #factorial << 1 << 5 << 7 << 3
+		)",
+		R"(
+			set isPrime << {
+				#return << #{
+					#final << #false << #[true] << (@@ % @ = 0)
+					#again << #(@ - 1) << #[true] << (@ > 2)
+					end; #return << true
+				} << (@ - 1)
+			}
+
+			#exit << #isPrime << 7 << 11 << 6 << 13 << 64 << 4
+		)",
+		R"(
+			set x << 1 << 2
+			set f << {
+				first; #return << "first"
+				#return << #string << #(x :: 1 * @) << #[1:3, 5] << @
+				last; #return << #[number] << "last"
+				end; #break << 0
+			}
+			#exit << "v" << #f << 1 << 2 << 3 << 4 << 5 << 6 << 7 << #{
+				#return << null << #[false] << true
+			} << 1
+		)",
+		R"(
+			#{
+				#exit << "deep" << #[true] << (@ = 0)
+				#return << #{ #return << #@@ << (@ - 1) } << @
+			} << 4
+			#exit << "unreachable"
+		)"
+	};
+
+	auto run = [] ( std::string& code, seq::Engine engine ) -> std::string {
+		auto buf = seq::Compiler::compileStatic( code );
+		seq::ByteBuffer bb( buf.data(), buf.size() );
+
+		seq::Executor exe;
+		exe.setEngine( engine );
+		exe.execute( bb );
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+		return str;
+	};
+
+	for( auto& code : programs ) {
+		CHECK_ELSE( run( code, seq::Engine::Threaded ), run( code, seq::Engine::Tree ) ) {
+			FAIL( "Threaded engine result doesn't match: " + run( code, seq::Engine::Threaded ) );
+		}
+
+		CHECK_ELSE( run( code, seq::Engine::Register ), run( code, seq::Engine::Tree ) ) {
+			FAIL( "Register engine result doesn't match: " + run( code, seq::Engine::Register ) );
+		}
+	}
+
+} );
+
+TEST( ce_tree_deep_recursion, {
+
+	std::string code = R"(
+		set count << {
+			#final << #@ << #[true] << (@ = 0)
+			#return << #count << (@ - 1)
+		}
+
+		#exit << #count << 4000
+	)";
+
+	// without optimizations the call isn't marked as a tail call, so each
+	// level uses the C++ stack, this depth was supported by older versions
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	seq::Executor exe;
+	exe.setEngine( seq::Engine::Tree );
+	exe.execute( bb );
+
+	CHECK( exe.getResults().size(), (size_t) 1 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 0 );
+
+} );
+
+TEST( ce_register_deep_recursion, {
+
+	std::string code = R"(
+		set deep << {
+			#exit << #@ << #[true] << (@ = 0)
+			#return << #deep << (@ - 1)
+		}
+
+		#exit << #deep << 10000
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	// the register machine doesn't use the C++ stack for Sequensa calls
+	seq::Executor exe;
+	exe.setEngine( seq::Engine::Register );
+	exe.execute( bb );
+
+	CHECK( exe.getResults().size(), (size_t) 1 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 0 );
+
+	// and all stack levels are popped on exit
+	CHECK( exe.getLevel( 1 ) == nullptr, true );
+
+} );
+
+TEST( ce_register_frames, {
+
+	std::string code = R"(
+		set deep << {
+			#final << #undefined << #[true] << (@ = 0)
+			#return << #{ #return << (@ + 1) } << #deep << (@ - 1)
+		}
+
+		#exit << #deep << 1000
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	seq::Executor exe;
+	exe.setEngine( seq::Engine::Register );
+
+	// frames of the failed call are released, and reused by the next one
+	for( int i = 0; i < 2; i ++ ) {
+		try{
+			exe.execute( bb );
+			FAIL( "Expected exception!" );
+		}catch( seq::RuntimeError& err ) {
+			CHECK_ELSE( std::string( err.what() ), std::string( "Referenced undefined symbol: 'undefined'" ) ) {
+				FAIL( "Unexpected error: " + std::string( err.what() ) );
+			}
+		}
+	}
+
+	std::string valid = "#exit << #{ #return << #{ #return << (@ * 2) } << @ } << 1 << 2";
+	buf = seq::Compiler::compileStatic( valid );
+	seq::ByteBuffer vbb( buf.data(), buf.size() );
+
+	exe.execute( vbb );
+	CHECK( exe.getResults().size(), (size_t) 2 );
+	CHECK( exe.getResults().at(1).Number().getLong(), (int64_t) 4 );
+
+} );
+
+TEST( ce_call_sites, {
+
+	// the call in 'g' is resolved to variables of different callers, at the same stack level
+	std::string code = R"(
+		set g << { #return << #f << @ }
+		set a << {
+			set f << { #return << "a" }
+			#return << #g << @
+		}
+		set b << {
+			set f << { #return << "b" << @ }
+			#return << #g << @
+		}
+		#exit << #b << 1 << #a << 2 << #b << 3
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	const seq::Engine engines[] = { seq::Engine::Tree, seq::Engine::Threaded, seq::Engine::Register };
+
+	for( seq::Engine engine : engines ) {
+		seq::Executor exe;
+		exe.setEngine( engine );
+		exe.execute( bb );
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+		CHECK_ELSE( str, std::string( "b 1 b a b a b a " ) ) {
+			FAIL( "Invalid result: " + str );
+		}
+	}
+
+	// cached natives are forgotten when the natives change
+	seq::type::Native first = [] (seq::Stream* stream) -> seq::Stream* { return nullptr; };
+	seq::type::Native second = [] (seq::Stream* stream) -> seq::Stream* { return nullptr; };
+
+	// names are cached by their address in the bytecode
+	static const byte origin = 0;
+
+	seq::Executor exe;
+	seq::type::Name name( true, false, "f", SEQ_NO_SLOT, &origin );
+	seq::Stream stream;
+
+	exe.inject( "f", first );
+	CHECK( exe.resolveCall( name, stream ) == first, true );
+	CHECK( exe.resolveCall( name, stream ) == first, true );
+
+	exe.inject( "f", second );
+	CHECK( exe.resolveCall( name, stream ) == second, true );
+
+	exe.reset();
+	exe.define( "f", { seq::util::newNumber( 5 ) } );
+	CHECK( exe.resolveCall( name, stream ) == nullptr, true );
+	CHECK( stream.size(), (size_t) 1 );
+	CHECK( stream[0].Number().getLong(), (int64_t) 5 );
+
+} );
+
+TEST( ce_link, {
+
+	std::string code = R"(
+		set f << { #return << #native << @ }
+		#exit << #f << #defined << #missing << 1
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	seq::Executor parent;
+	parent.inject( "native", native_join_strings );
+
+	seq::Executor exe( &parent );
+	exe.define( "defined", { seq::util::newNull() } );
+
+	auto unresolved = exe.link( bb );
+	CHECK( unresolved.size(), (size_t) 1 );
+	CHECK_ELSE( unresolved.at(0), std::string( "missing" ) ) {
+		FAIL( "Invalid unresolved name: " + unresolved.at(0) );
+	}
+
+	// natives of the parent are bound to the linked executor
+	CHECK( exe.getNativesMap().count( "native" ), (size_t) 1 );
+
+	exe.inject( "missing", [] (seq::Stream* stream) -> seq::Stream* { return nullptr; } );
+	CHECK( exe.link( bb ).size(), (size_t) 0 );
+
+} );
+
+TEST( ce_symbols, {
+
+	std::string code = R"(
+		set s << "constant"
+		#exit << (s :: 0) << ((s :: 0) = "constant") << (("const" + "ant") = (s :: 0)) << ((s :: 0) != "other") << (std:value :: 0 + 1) << (var :: 0) << #{ #return << "constant" } << 1
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	const seq::Engine engines[] = { seq::Engine::Tree, seq::Engine::Threaded, seq::Engine::Register };
+
+	for( seq::Engine engine : engines ) {
+		seq::Executor exe;
+		exe.setEngine( engine );
+		exe.define( "std:value", { seq::util::newNumber( 41 ) } );
+
+		// variables set directly on the stack level are found by name
+		std::string name = "var";
+		exe.getTopLevel()->setVar( name, { seq::util::newNumber( 7 ) } );
+		exe.execute( bb );
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+		CHECK_ELSE( str, std::string( "constant true true true 42 7 constant " ) ) {
+			FAIL( "Invalid result: " + str );
+		}
+
+		// equal string constants share a single value
+		CHECK( &exe.getResults().at(0).String() == &exe.getResults().at(6).String(), true );
+	}
+
+	// executors sharing a name keep their own slots for it
+	static const byte origin = 0;
+	seq::type::Name name( false, false, "y", SEQ_NO_SLOT, &origin );
+
+	seq::Executor a, b;
+	a.define( "x", { seq::util::newNumber( 1 ) } );
+	a.define( "y", { seq::util::newNumber( 2 ) } );
+	b.define( "y", { seq::util::newNumber( 3 ) } );
+
+	for( int i = 0; i < 2; i ++ ) {
+		CHECK( a.resolveName( name, false ).at(0).Number().getLong(), (int64_t) 2 );
+		CHECK( b.resolveName( name, false ).at(0).Number().getLong(), (int64_t) 3 );
+	}
+
+} );
+
+TEST( ce_tail_call, {
+
+	std::string code = R"(
+		set count << {
+			#final << #@ << #[true] << (@ <= 0)
+			#return << #count << (@ - 1)
+		}
+		set sum << {
+			#final << #@@ << #[true] << (@ <= 0)
+			#final << #sum << (@ - 1)
+		}
+		set f << {
+			#return << "a" << @
+			#final << #{ #return << @ << 1 } << (@ * 2)
+		}
+		set g << { #return << #f << @ }
+		set h << {
+			set v << 1
+			#return << #g << @
+		}
+		set a << #sum << 3
+		set b << #g << 3 << 4
+		set c << #h << 5
+		set d << #count << 100000
+		#exit << d << a << b << c
+	)";
+
+	auto run = [] ( std::string& code, seq::oflag_t flags ) -> std::string {
+		auto buf = seq::Compiler::compileStatic( code, nullptr, flags );
+		seq::ByteBuffer bb( buf.data(), buf.size() );
+
+		seq::Executor exe;
+		exe.execute( bb );
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+		return str;
+	};
+
+	// the tail calls reuse the stack level, so the recursion doesn't exhaust the native stack
+	CHECK_ELSE( run( code, (seq::oflag_t) seq::Optimizations::TailCall ), std::string( "0 1 a 3 6 1 a 4 8 1 a 5 10 1 " ) ) {
+		FAIL( "Invalid result: " + run( code, (seq::oflag_t) seq::Optimizations::TailCall ) );
+	}
+
+	code.replace( code.find( "100000" ), 6, "100" );
+
+	CHECK_ELSE( run( code, (seq::oflag_t) seq::Optimizations::TailCall ), run( code, (seq::oflag_t) seq::Optimizations::None ) ) {
+		FAIL( "Tail call result doesn't match: " + run( code, (seq::oflag_t) seq::Optimizations::TailCall ) );
+	}
+
+} );
+
+TEST( ce_memoization, {
+
+	std::string code = R"(
+		set fib << {
+			#final << #@ << #[true] << (@ <= 1)
+			#final << #{
+				#final << #{
+					#final << (@ + @@)
+				} << #fib << (@@ - 2)
+			} << #fib << (@ - 1)
+		}
+		set count << {
+			set n << (n :: 0 + 1)
+			#return << n
+		}
+		set n << 0
+		set a << #fib << 20
+		set b << #count << 1 << #count << 1
+		set fib << {
+			#return << "redefined"
+		}
+		#exit << a << b << #fib << 20
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	seq::Executor exe;
+	exe.execute( bb );
+
+	std::string str;
+	for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+	CHECK_ELSE( str, std::string( "6765 2 3 redefined " ) ) {
+		FAIL( "Invalid result: " + str );
+	}
+
+	// every fib argument is only computed once, and the redefined fib is called once
+	CHECK( exe.getCacheMisses(), 22ul );
+	CHECK( exe.getCacheHits(), 18ul );
+
+	exe.setMemoization( false );
+	exe.execute( bb );
+
+	CHECK( exe.getCacheMisses(), 22ul );
+	CHECK( exe.getResults().size(), (size_t) 4 );
+
+} );
+
+TEST( ce_jit, {
+
+	std::string code = R"(
+		set s << 0
+		set n << 0
+		set r << 0
+		set sum << {
+			first; set x << 0
+			set x << (x :: 0 + @)
+			end; #return << x
+		}
+		#{
+			set s << (s :: 0 + (@ * 0.5 - @ / 3) * (@ + 1))
+			set t << #sum << 0 << #[1:100, 150, 200:300] << (@ - 7) << @ << "x" << null
+			set n << (n :: 0 + t :: 0)
+			set r << (@ * 0 / 0 = @ * 0 / 0) << (@ / 0 > 1) << (@ * 0 / 0 != 1) << (@ <= 2) << (@ > 2) << (@ >= 2)
+			#again << #(@ - 1) << #[true] << (@ > 0)
+		} << 5000
+		#exit << s << n << r << (@ + 1)
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	auto run = [&] ( bool jit ) -> std::string {
+		seq::Executor exe;
+		exe.setJit( jit );
+		exe.execute( bb );
+
+#		ifdef SEQ_JIT_NATIVE
+		CHECK( exe.getJit().getCompiled() > 0, jit );
+#		endif
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+		return str;
+	};
+
+	CHECK_ELSE( run( true ), run( false ) ) {
+		FAIL( "Native result doesn't match: " + run( true ) );
+	}
+
+} );
+
+TEST( ce_integer_math, {
+
+	std::string code = R"(
+		set sq << {
+			#return << (@ * @ + 1)
+		}
+		set a << #sq << 3037000499
+		set b << #sq << 4294967296
+		set c << #{
+			#return << (@ + 1) << (@ / 7) << (@ % 7) << (0 - @ / 2)
+		} << 9007199254740992
+		#exit << a << b << c << (10 / 4) << (7 % -1)
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+	seq::Executor exe;
+	exe.execute( bb );
+
+	std::string str;
+	for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+	CHECK_ELSE( str, std::string( "9223372030926249002 18446744073709551616.000000 9007199254740993 1286742750677284.500000 4 -4503599627370496 2.500000 0 " ) ) {
+		FAIL( "Invalid result: " + str );
+	}
+	CHECK( exe.getResults()[0].Number().isNatural(), true );
+	CHECK( exe.getResults()[1].Number().isNatural(), false );
+	CHECK( seq::util::newNumber( -0.0 ).Number().isNatural(), true );
+
+} );
+
+TEST( ce_memoization_naturals, {
+
+	std::string code = R"(
+		set f << {
+			#return << (@ - 9007199254740992)
+		}
+		set a << #f << (9007199254740992 + 1)
+		set b << #f << (9007199254740992 + 0)
+		#exit << a << b
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	const seq::Engine engines[] = { seq::Engine::Tree, seq::Engine::Threaded, seq::Engine::Register };
+
+	// both arguments are the same double, but different naturals
+	for( seq::Engine engine : engines ) {
+		seq::Executor exe;
+		exe.setEngine( engine );
+		exe.execute( bb );
+
+		std::string str;
+		for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+		CHECK_ELSE( str, std::string( "1 0 " ) ) {
+			FAIL( "Invalid result: " + str );
+		}
+	}
+
+} );
+
+TEST( ce_expression_tree, {
+
+	std::string code = R"(
+		set f << {
+			#return << (@ * 2 + 1) << (@ + "!") << (@ > 2) << (@@ - @) << (@@@ * 2)
+		}
+		set v << 5 << 6 << 7
+		#exit << #f << 3 << "x" << 2.5 << null << (v :: 1 * 2) << (1 + 2 * 3 = 7)
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+	seq::Executor exe;
+	exe.setJit( false );
+	exe.execute( bb );
+
+	std::string str;
+	for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+	CHECK_ELSE( str, std::string( "7 null true null null null x! null null null 6 null true null null null null null null null 25 null true null null null null null null null " ) ) {
+		FAIL( "Invalid result: " + str );
+	}
+
+} );
+
+TEST( ce_flowc_matcher, {
+
+	std::string code = R"(
+		set in << 0 << 1 << 2 << 5 << 6 << 9 << 10 << 12 << 2.5 << "+" << "-" << "x" << true << false << null << number << (0 / 0)
+		set a << #[1:5, 5:9, 3:6, 11, "+", "<"] << in
+		set b << #[12:10, false, null, string] << in
+		set c << #[bool, 0:2.5, 10] << in
+		#exit << a << "|" << b << "|" << c
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+	seq::Executor exe;
+	exe.setJit( false );
+	exe.execute( bb );
+
+	std::string str;
+	for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+	CHECK_ELSE( str, std::string( "2 5 6 2.500000 + | + - x false null | 1 2 10 true false " ) ) {
+		FAIL( "Invalid result: " + str );
+	}
+
+} );
+
+TEST( ce_batch, {
+
+	std::string code = R"(
+		set in << 1 << 2 << 3 << 4.5 << 0 << -7 << 100 << 3037000499 << 0.1 << 12
+		set a << #{
+			#return << (@ * 2 + 1)
+		} << in
+		set b << #{
+			#return << (@ * @ - @ / 4)
+		} << in
+		set c << #{
+			#return << (1 - @ * 0.5)
+		} << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8 << "x"
+		set d << #[0:4, 11:13, 100] << in
+		#exit << a << "|" << b << "|" << c << "|" << d
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+	seq::Executor exe;
+	exe.setJit( false );
+	exe.execute( bb );
+
+	std::string str;
+	for( auto& g : exe.getResults() ) str += seq::util::stringCast( g ).String().getString() + " ";
+
+	CHECK_ELSE( str, std::string( "3 5 7 10 1 -13 201 6074000999 1.200000 25 | 0.750000 3.500000 8.250000 19.125000 0 50.750000 9975 9223372030166999040 -0.015000 141 | 0.500000 0 -0.500000 -1 -1.500000 -2 -2.500000 -3 null | 1 2 3 100 0.100000 12 " ) ) {
+		FAIL( "Invalid result: " + str );
+	}
+
+} );
+
+TEST( api_batch_kernels, {
+
+	std::vector<double> values { 3, -1, 4, 1, -5, 9, 2, 6, 5 };
+	std::vector<double> other( values.size(), 2 );
+	std::vector<double> result( values.size() );
+	std::vector<seq::byte> mask( values.size() );
+
+	CHECK( seq::util::batchSum( values.data(), values.size() ), 24.0 );
+	CHECK( seq::util::batchMin( values.data(), values.size() ), -5.0 );
+	CHECK( seq::util::batchMax( values.data(), values.size() ), 9.0 );
+	CHECK( seq::util::batchBound( values.data(), values.size() ), 9.0 );
+
+	seq::util::batchOperation( seq::ExprOperator::Subtraction, values.data(), other.data(), result.data(), values.size() );
+	CHECK( result[8], 3.0 );
+
+	seq::util::batchRange( 1, 5, values.data(), mask.data(), values.size() );
+	CHECK( (int) std::count( mask.begin(), mask.end(), 1 ), 3 );
+
+	seq::util::batchAbs( values.data(), values.size() );
+	CHECK( values[4], 5.0 );
+
+	// NaN is ignored unless it's the first value
+	values[5] = NAN;
+	CHECK( seq::util::batchMax( values.data(), values.size() ), 6.0 );
+	CHECK( std::isinf( seq::util::batchBound( values.data(), values.size() ) ), true );
+
+	values[0] = NAN;
+	CHECK( std::isnan( seq::util::batchMin( values.data(), values.size() ) ), true );
+
+} );
+
+TEST( api_generic_inline, {
+
+	seq::Generic num = seq::util::newNumber( 42 );
+	seq::Generic str = seq::util::newString( "42" );
+
+	CHECK( num.isInline(), true );
+	CHECK( str.isInline(), false );
+
+	// copies and moves keep values in place
+	seq::Stream stream;
+	for( int i = 0; i < 100; i ++ ) {
+		stream.push_back( num );
+		stream.insert( stream.begin(), str );
+	}
+
+	seq::Generic moved = std::move( stream.back() );
+	CHECK( moved.isInline(), true );
+	CHECK( moved.Number().getLong(), (int64_t) 42 );
+	CHECK_ELSE( stream.front().String().getString(), std::string( "42" ) ) {
+		FAIL( "Invalid string!" );
+	}
+
+	// assignment replaces both kinds of storage
+	moved = str;
+	CHECK( moved.isInline(), false );
+	CHECK_ELSE( moved.String().getString(), std::string( "42" ) ) {
+		FAIL( "Invalid string!" );
+	}
+
+	moved = seq::util::newBool( true );
+	CHECK( moved.isInline(), true );
+	CHECK( moved.Bool().getBool(), true );
+
+	// every inline type is copied as itself
+	seq::Stream values = { seq::util::newNull(), seq::util::newBool( false ), seq::Generic( seq::type::Type( true, seq::DataType::String ) ), seq::Generic( seq::type::VMCall( false, seq::type::VMCall::CallType::Exit ) ), seq::Generic( seq::type::Arg( false, 2 ) ) };
+	seq::Stream copies = values;
+
+	for( size_t i = 0; i < values.size(); i ++ ) {
+		CHECK( copies[i].isInline(), true );
+		CHECK( (byte) copies[i].getDataType(), (byte) values[i].getDataType() );
+		CHECK( copies[i].getAnchor(), values[i].getAnchor() );
+	}
+
+	CHECK( (byte) copies[2].Type().getType(), (byte) seq::DataType::String );
+	CHECK( (byte) copies[3].VMCall().getCall(), (byte) seq::type::VMCall::CallType::Exit );
+	CHECK( (int) copies[4].Arg().getLevel(), 2 );
+
+	// heap allocated values are still accepted
+	seq::Generic heap( new seq::type::Number( false, 7.0 ) );
+	CHECK( heap.isInline(), false );
+	CHECK( seq::Generic( heap ).Number().getLong(), (int64_t) 7 );
+
+} );
+
+TEST( bench_shared_payloads, {
+
+	seq::Generic str = seq::util::newString( "Lorem ipsum dolor sit amet, consectetur adipiscing elit" );
+
+	// copying a string only bumps the reference counter
+	long start = allocation_count;
+	seq::Stream copies( 1000, str );
+	CHECK( allocation_count - start, 1l );
+
+	// the anchor is kept by each copy, so the shared value is neither copied nor modified
+	start = allocation_count;
+	copies[0].setAnchor( true );
+	CHECK( allocation_count - start, 0l );
+	CHECK( copies[0].getAnchor(), true );
+	CHECK( copies[1].getAnchor(), false );
+	CHECK( str.getAnchor(), false );
+	CHECK( seq::Generic( copies[0] ).getAnchor(), true );
+	CHECK( &copies[0].String() == &str.String(), true );
+
+	std::string code = R"(
+		set text << "Lorem ipsum dolor sit amet, consectetur adipiscing elit"
+		set echo << {
+			#return << @ << @
+		}
+
+		set count << {
+			first; set c << 0
+			set c << (c :: 0 + 1)
+			end; #return << c
+		}
+
+		#exit << #count << #echo << #{
+			#return << text << @ << text
+		} << text << text << text << text << text << text << text << text
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	seq::Executor exe;
+	exe.execute( bb );
+
+	// first execution fills the decode cache
+	start = allocation_count;
+	exe.execute( bb );
+	long allocations = allocation_count - start;
+
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 48 );
+
+	// 3 top level streams, 8 anonymous function calls, 24 echo calls and 48 count calls
+	long streams = 3 + 8 + 24 + 48;
+	std::cout << "Allocations per executed stream: " << (allocations / streams) << std::endl;
+
+	// deep copying payloads used to cost ~47 allocations per stream here
+	ASSERT( allocations / streams < 16, "Too many allocations!" );
+
+} );
+
+TEST( api_pool, {
+
+	const unsigned long allocations = seq::Pool::getAllocations();
+	const unsigned long releases = seq::Pool::getReleases();
+	const void* address;
+
+	{
+		seq::Generic str = seq::util::newString( "pooled" );
+		address = &str.String();
+	}
+
+	// freed blocks are reused by objects of the same size class
+	seq::Generic str = seq::util::newString( "reused" );
+	CHECK( (const void*) &str.String() == address, true );
+	CHECK( seq::Pool::getAllocations() - allocations, 2ul );
+	CHECK( seq::Pool::getReleases() - releases, 1ul );
+
+	// pooled objects don't use the global heap
+	long start = allocation_count;
+	for( int i = 0; i < 1000; i ++ ) {
+		seq::Generic name = seq::util::newString( "" );
+	}
+	CHECK( allocation_count - start, 0l );
+
+} );
+
+TEST( api_stream_inline, {
+
+	long start = allocation_count;
+
+	// small streams keep their elements inline
+	seq::Stream stream;
+	for( int i = 0; i < SEQ_STREAM_INLINE; i ++ ) stream.push_back( seq::util::newNumber( i ) );
+	seq::Stream moved( std::move( stream ) );
+
+	CHECK( allocation_count - start, 0l );
+	CHECK( moved.isInline(), true );
+	CHECK( stream.empty(), true );
+	CHECK( moved.size(), (size_t) SEQ_STREAM_INLINE );
+	CHECK( moved.back().Number().getLong(), (int64_t) SEQ_STREAM_INLINE - 1 );
+
+	// and move to the heap once they outgrow the buffer
+	moved = seq::Stream { seq::util::newNumber( 1 ), seq::util::newNumber( 2 ) };
+	moved.push_back( seq::util::newBool( true ) );
+	moved.insert( moved.begin(), seq::util::newNumber( 0 ) );
+
+	CHECK( moved.size(), (size_t) 4 );
+	CHECK( moved[0].Number().getLong(), (int64_t) 0 );
+	CHECK( moved[2].Number().getLong(), (int64_t) 2 );
+	CHECK( moved.back().Bool().getBool(), true );
+
+	for( int i = 0; i < 100; i ++ ) moved.push_back( moved[i] );
+	moved.erase( moved.begin(), moved.begin() + 50 );
+
+	CHECK( moved.isInline(), false );
+	CHECK( moved.size(), (size_t) 54 );
+	CHECK( moved[0].Number().getLong(), (int64_t) 2 );
+	CHECK( moved[2].Number().getLong(), (int64_t) 0 );
+
+	seq::Stream copy( moved.rbegin(), moved.rend() );
+	CHECK( copy.size(), (size_t) 54 );
+	CHECK( copy[53].Number().getLong(), (int64_t) 2 );
+
+	copy.resize( 2 );
+	copy.swap( moved );
+	CHECK( moved.size(), (size_t) 2 );
+	CHECK( copy.size(), (size_t) 54 );
+
+} );
+
+TEST( api_call_stack, {
+
+	seq::CallStack stack;
+	seq::StackLevel& top = stack.push();
+
+	// levels with many variables switch to the index
+	for( int i = 0; i < 20; i ++ ) {
+		std::string name = "var" + std::to_string( i );
+		top.setVar( name, seq::Stream { seq::util::newNumber( i ) } );
+	}
+
+	std::string name = "var7";
+	top.setVar( name, seq::Stream { seq::util::newNumber( 70 ) } );
+
+	for( int i = 0; i < 20; i ++ ) {
+		std::string name = "var" + std::to_string( i );
+		CHECK( top.hasVar( name ), true );
+		CHECK( top.getVar( name, false )[0].Number().getLong(), (int64_t) ( i == 7 ? 70 : i ) );
+	}
+
+	// levels don't move as the stack grows
+	seq::StackLevel* level = &stack.push();
+	for( int i = 0; i < 100; i ++ ) stack.push();
+
+	CHECK( &stack[0] == &top, true );
+	CHECK( &stack[1] == level, true );
+	CHECK( stack.size(), (size_t) 102 );
+
+	// popped levels are cleared and reused
+	name = "local";
+	level->setVar( name, seq::Stream { seq::util::newBool( true ) } );
+	for( int i = 0; i < 101; i ++ ) stack.pop();
+
+	CHECK( &stack.push() == level, true );
+	CHECK( level->isEmpty(), true );
+	CHECK( level->hasVar( name ), false );
+
+} );
+
+TEST( bench_allocation_budget, {
+
+	// programs and the maximum number of allocations they can make (for each engine),
+	// if a change makes any of those exceed the budget it is most probably copying streams
+	const std::vector<std::pair<std::string, long>> programs = {
+		{ "#exit << 1 << 2 << 3", 13 },
+		{ "#exit << (2 * 3) << (4 + 5)", 22 },
+		{ "set a << 1 << 2\n#exit << a << a", 27 },
+		{ "#exit << #{ #return << (@ * 2) } << 1 << 2 << 3", 32 },
+		{ "#exit << #[1:5] << 1 << 2 << 3 << 4 << 5 << 6", 27 },
+		{ "#exit << #{ #again << #(@ - 1) << #[true] << (@ > 0) } << 1000", 56 },
+		{ "set f << { #return << #f << #[true] << (@ - 1) << #[true] << (@ > 0) }\n#exit << #f << 100", 72 },
+		{ "set s << \"text\"\n#exit << #{ #return << s << @ } << 1 << 2 << 3", 42 },
+		{ "set a << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8\n#exit << a << a", 31 },
+		{ "set f << { #return << @ << \"a\" }\n#exit << #f << 1 << 2 << 3 << 4 << 5 << 6 << 7 << 8", 52 },
+	};
+
+	const seq::Engine engines[] = { seq::Engine::Tree, seq::Engine::Threaded, seq::Engine::Register };
+
+	for( auto& program : programs ) {
+		for( seq::Engine engine : engines ) {
+			long allocations = count_allocations( program.first, engine );
+
+			CHECK_ELSE( allocations <= program.second, true ) {
+				FAIL( "Program '" + program.first + "' made " + std::to_string( allocations ) + " allocations!" );
+			}
+		}
+	}
+
+} );
+
+TEST( bench_call_heavy, {
+
+	std::string code = R"(
+		set fib << {
+			#final << #@ << #[true] << (@ <= 1)
+			#return << #{
+				#return << (@@ + @)
+			} << 0 << #fib << (@ - 1) << (@ - 2)
+		}
+
+		set deep << {
+			#exit << #@ << #[true] << (@ = 0)
+			#return << #deep << (@ - 1)
+		}
+
+		#exit << #deep << #fib << 12
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	auto start = std::chrono::steady_clock::now();
+
+	for( int i = 0; i < 10; i ++ ) {
+		seq::Executor exe;
+		exe.execute( bb );
+
+		// fib(12) = 144, then #deep exits from 144 nested calls
+		CHECK( exe.getResult().Number().getLong(), (int64_t) 0 );
+	}
+
+	std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+	std::cout << "Call heavy script (10 runs): " << time.count() << "ms" << std::endl;
+
+} );
+
+TEST( bench_stream_scaling, {
+
+	const int sizes[] = { 10, 1000, 100000 };
+
+	for( int size : sizes ) {
+		std::string code = "#exit";
+		for( int i = 0; i < size; i ++ ) {
+			code += " << " + std::to_string( i % 100 );
+		}
+
+		auto buf = seq::Compiler::compileStatic( code );
+		seq::ByteBuffer bb( buf.data(), buf.size() );
+		seq::Executor exe;
+
+		auto start = std::chrono::steady_clock::now();
+		exe.execute( bb );
+		std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+		CHECK( exe.getResults().size(), (size_t) size );
+		CHECK( exe.getResults().front().Number().getLong(), (int64_t) 0 );
+		CHECK( exe.getResults().back().Number().getLong(), (int64_t) ( ( size - 1 ) % 100 ) );
+
+		std::cout << "Stream of " << size << " values: " << time.count() << "ms" << std::endl;
+	}
+
+} );
+
+TEST( bench_again_queue, {
+
+	std::string code = "#exit << #{\n#again << #(@ - 1) << #[true] << (@ > 0)\nend; #return << 1\n}";
+	for( int i = 0; i < 50000; i ++ ) {
+		code += " << 1";
+	}
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+	seq::Executor exe;
+
+	auto start = std::chrono::steady_clock::now();
+	exe.execute( bb );
+	std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+	// each argument is reinserted once before reaching the 'end' tag
+	CHECK( exe.getResults().size(), (size_t) 1 );
+	CHECK( exe.getResult().Number().getLong(), (int64_t) 1 );
+
+	std::cout << "Again loop over 50000 arguments: " << time.count() << "ms" << std::endl;
+
+} );
+
+TEST( bench_engines, {
+
+	std::string code = R"(
+		set sum << {
+			first; set x << 0
+			set x << (x :: 0 + @)
+			last; #return << x
+		}
+
+		set fib << {
+			#final << #@ << #[true] << (@ <= 1)
+			#return << #sum << #fib << (@ - 1) << (@ - 2)
+		}
+
+		set s << 0
+		#{
+			set s << (s :: 0 + @)
+			#again << #(@ - 1) << #[true] << (@ > 0)
+		} << 2000
+
+		#exit << s << #fib << 15
+	)";
+
+	auto buf = seq::Compiler::compileStatic( code );
+	seq::ByteBuffer bb( buf.data(), buf.size() );
+
+	const seq::Engine engines[] = { seq::Engine::Tree, seq::Engine::Threaded, seq::Engine::Register };
+	const char* names[] = { "tree", "threaded", "register" };
+
+	for( int i = 0; i < 3; i ++ ) {
+		seq::Executor exe;
+		exe.setEngine( engines[i] );
+
+		auto start = std::chrono::steady_clock::now();
+		exe.execute( bb );
+		std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+
+		CHECK( exe.getResults().size(), (size_t) 2 );
+		CHECK( exe.getResults().at(0).Number().getLong(), (int64_t) 2001000 );
+		CHECK( exe.getResults().at(1).Number().getLong(), (int64_t) 610 );
+
+		std::cout << "Engine " << names[i] << ": " << time.count() << "ms" << std::endl;
+	}
+
+} );
+
 REGISTER_EXCEPTION( seq_compiler_error, seq::CompilerError );
 REGISTER_EXCEPTION( seq_internal_error, seq::InternalError );
 REGISTER_EXCEPTION( seq_runtime_error, seq::RuntimeError );
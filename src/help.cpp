@@ -61,6 +61,7 @@ void help( ArgParse& argp ) {
 		std::cout << "  -e               Print exit stream." << std::endl;
 		std::cout << "  -S               Enable strict math." << std::endl;
 		std::cout << "  -o               Enable compiler optimizations." << std::endl;
+		std::cout << "  --engine ENGINE  Select execution engine, 'tree' (default), 'threaded' or 'register'." << std::endl;
 
 		std::cout << std::endl;
 		std::cout << "Example:" << std::endl;
@@ -90,8 +91,8 @@ void help( ArgParse& argp ) {
 	}
 
 	if( arg == "run" || arg == "r" ) {
-		std::cout << "Usage: sequensa --run [FILE]" << std::endl;
-		std::cout << "Execute compiled FILE." << std::endl;
+		std::cout << "Usage: sequensa --run [FILE] (--engine ENGINE)" << std::endl;
+		std::cout << "Execute compiled FILE, using the given ENGINE ('tree' - default, 'threaded' or 'register')." << std::endl;
 		return;
 	}
 
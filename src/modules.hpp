@@ -69,6 +69,7 @@ bool check_filename( std::string path, std::string expected );
 bool load_header( seq::FileHeader* header, seq::BufferReader& br, bool force );
 std::string posix_time_to_date( time_t rawtime );
 bool validate_version( seq::FileHeader& header, bool force, bool verbose );
+bool link_program( seq::Executor& exe, const seq::ByteBuffer& bytecode, bool force );
 bool file_exist( const char *path );
 std::string get_exe_path();
 std::string get_cwd_path();
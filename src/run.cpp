@@ -26,7 +26,7 @@
 #include "api/SeqAPI.hpp"
 #include "modules.hpp"
 
-void run( std::string input, Options opt ) {
+void run( std::string input, Options opt, seq::Engine engine ) {
 
 	std::ifstream infile( input, std::ios::binary );
 	if( infile.good() ) {
@@ -58,7 +58,13 @@ void run( std::string input, Options opt ) {
 				return;
 			}
 
+			if( !link_program( exe, bytecode, opt.force_execution ) ) {
+				std::cout << "Failed to link program, start aborted!" << std::endl;
+				return;
+			}
+
 			exe.setStrictMath( opt.strict_math );
+			exe.setEngine( engine );
 			exe.execute( bytecode );
 
 			if( opt.print_exit ) {
@@ -73,6 +79,9 @@ void run( std::string input, Options opt ) {
 				}
 			}
 
+			if( opt.verbose ) {
+				std::cout << "Pool allocations: " << seq::Pool::getAllocations() << ", releases: " << seq::Pool::getReleases() << ", chunks: " << seq::Pool::getChunks() << std::endl;
+			}
 
 		}catch( seq::RuntimeError& err ) {
 
@@ -103,9 +112,24 @@ void run( std::string input, Options opt ) {
 void run( ArgParse& argp, Options opt ) {
 
 	auto vars = argp.getArgs("--run", "-r");
+	auto engines = argp.getArgs("--engine");
+	seq::Engine engine = seq::Engine::Tree;
+
+	if( argp.hasFlag("--engine") ) {
+		if( engines.size() == 1 && engines.at(0) == "tree" ) {
+			engine = seq::Engine::Tree;
+		}else if( engines.size() == 1 && engines.at(0) == "threaded" ) {
+			engine = seq::Engine::Threaded;
+		}else if( engines.size() == 1 && engines.at(0) == "register" ) {
+			engine = seq::Engine::Register;
+		}else{
+			USAGE_HELP("Expected engine name, 'tree', 'threaded' or 'register'!", "run");
+			return;
+		}
+	}
 
 	if( vars.size() == 1 ) {
-		run( vars.at(0), opt );
+		run( vars.at(0), opt, engine );
 	}else{
 		USAGE_HELP("Expected one filename!", "run");
 	}
@@ -64,7 +64,9 @@ seq::Stream* seq_std_mixin( seq::Stream* input ) {
 			auto buf = seq::Compiler::compileStatic( code );
 			seq::ByteBuffer bb( buf.data(), buf.size() );
 
+			// bind the natives of the parent executor, so that their calls can be cached
 			seq::Executor exe(executor);
+			exe.link( bb );
 			exe.execute( bb );
 
 			output->insert(output->end(), exe.getResults().begin(), exe.getResults().end());
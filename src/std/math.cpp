@@ -28,6 +28,11 @@
 
 #define PI 3.14159265
 
+// streams of numbers are processed using batch kernels
+static bool pack( seq::Stream* input, std::vector<double>& values ) {
+	return input->size() >= SEQ_BATCH_MIN && seq::util::packNumbers( *input, values );
+}
+
 seq::Stream* seq_std_rand( seq::Stream* input ) {
 	seq::Stream* output = new seq::Stream();
 
@@ -104,6 +109,18 @@ seq::Stream* seq_std_sum( seq::Stream* input ) {
 
 seq::Stream* seq_std_abs( seq::Stream* input ) {
 	seq::Stream* output = new seq::Stream();
+	std::vector<double> values;
+
+	if( pack( input, values ) ) {
+		seq::util::batchAbs( values.data(), values.size() );
+		output->reserve( values.size() );
+
+		for( double value : values ) {
+			output->push_back( seq::util::newNumber( value ) );
+		}
+
+		return output;
+	}
 
 	for( auto& arg : *input ) {
 
@@ -116,6 +133,13 @@ seq::Stream* seq_std_abs( seq::Stream* input ) {
 
 seq::Stream* seq_std_min( seq::Stream* input ) {
 	const int s = input->size();
+	std::vector<double> values;
+
+	if( pack( input, values ) ) {
+		return new seq::Stream {
+			seq::util::newNumber( seq::util::batchMin( values.data(), values.size() ) )
+		};
+	}
 
 	double min = seq::util::numberCast( input->at(0) ).Number().getDouble();
 
@@ -133,6 +157,13 @@ seq::Stream* seq_std_min( seq::Stream* input ) {
 
 seq::Stream* seq_std_max( seq::Stream* input ) {
 	const int s = input->size();
+	std::vector<double> values;
+
+	if( pack( input, values ) ) {
+		return new seq::Stream {
+			seq::util::newNumber( seq::util::batchMax( values.data(), values.size() ) )
+		};
+	}
 
 	double max = seq::util::numberCast( input->at(0) ).Number().getDouble();
 
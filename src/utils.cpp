@@ -214,6 +214,30 @@ bool validate_version( seq::FileHeader& header, bool force, bool verbose ) {
 	return true;
 }
 
+bool link_program( seq::Executor& exe, const seq::ByteBuffer& bytecode, bool force ) {
+
+	std::vector<std::string> unresolved = exe.link( bytecode );
+
+	if( !unresolved.empty() ) {
+
+		for( std::string& name : unresolved ) {
+			std::cout << "Error! Unresolved function: '" << name << "'!" << std::endl;
+		}
+
+		std::cout << "To force Sequensa to continue run again with '-f'." << std::endl;
+
+		// continue regardless of missing functions
+		if( force ) {
+			std::cout << "Sequensa forced to continue, issues may occur!" << std::endl;
+		}else{
+			return false;
+		}
+
+	}
+
+	return true;
+}
+
 bool file_exist( const char *path ) {
     std::ifstream infile(path);
     return infile.good();